@@ -1,6 +1,35 @@
 #include "Debug.h"
 #include <cstdio> // For TextFormat
+#include <cmath>
 #include "../globals.h" // Added to access 'hueSpeed'
+#include "../audioring.h"
+#include "../analysis.h"
+#include "../latency.h"
+#include "../audiohealth.h"
+#include "../audiosource.h"
+#include "../capture.h"
+#include "../gravityorbs.h"
+#include "GetColorFromHue.h"
+
+#define LATENCY_DUMP_FILE "latency.csv"
+#define HEALTH_DUMP_FILE  "audio_health.csv"
+#define CAPTURE_FILE      "show.vbcap"
+
+// Click-to-advance button in the ToggleControl style. Returns true when clicked.
+static bool DrawCycleButton(Rectangle bounds, const char* text, float uiScale, float hue) {
+    Vector2 mousePos = GetMousePosition();
+    bool isHover = CheckCollisionPointRec(mousePos, bounds);
+    Color hueColor = GetColorFromHue((int)hue);
+
+    DrawRectangleRec(bounds, isHover ? Fade(DARKGRAY, 0.8f) : Fade(DARKGRAY, 0.6f));
+    DrawRectangleLinesEx(bounds, 1.0f * uiScale, isHover ? hueColor : GRAY);
+
+    int fontSize = (int)(16 * uiScale);
+    int textWidth = MeasureText(text, fontSize);
+    DrawText(text, (int)(bounds.x + (bounds.width - textWidth) / 2.0f), (int)(bounds.y + (bounds.height - fontSize) / 2.0f), fontSize, WHITE);
+
+    return isHover && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+}
 
 DebugMenu::DebugMenu(float& globalHue)
     : hueRef(globalHue),
@@ -43,8 +72,209 @@ float DebugMenu::Draw(float offsetX, float offsetY, float width, float uiScale,
         DrawText(TextFormat("Hue Speed: %.1f/sec", hueSpeed), (int)(offsetX + padding), (int)textY, fontSize, textColor);
         textY += lineHeight;
 
+        // Audio ring fill level and blocks dropped by the callback
+        DrawText(TextFormat("Audio Ring: %i/%i", (int)gAudioRing.Size(), (int)AudioRing::GetCapacity()), (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+        DrawText(TextFormat("Audio Overruns: %llu", (unsigned long long)gAudioRing.Overruns()), (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+
+        // Callback health: device xruns, dropped blocks, timing and cost
+        AudioHealthStats health = GetAudioHealthStats();
+        DrawText(TextFormat("Xruns: %llu over / %llu under  Dropped: %llu", (unsigned long long)health.inputOverflows,
+                            (unsigned long long)health.inputUnderflows, (unsigned long long)health.droppedBlocks),
+                 (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+        DrawText(TextFormat("Callback: %.2f ms (max %.1f, jitter %.2f)  Late: %llu", health.intervalMeanMs, health.intervalMaxMs,
+                            health.jitterRmsMs, (unsigned long long)health.lateCallbacks),
+                 (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+        DrawText(TextFormat("Callback CPU: %.0f us (max %.0f)  Load: %.1f%%", health.callbackMeanUs, health.callbackMaxUs, health.cpuLoad * 100.0f),
+                 (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+
+        // Tempo and beat phase
+        AnalysisSnapshot analysis = GetLatestAnalysis();
+        DrawText(TextFormat("BPM: %.1f  Beats: %llu  Phase: %.2f", analysis.bpm, (unsigned long long)analysis.beatCount, analysis.beatPhase), (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+
+        // Band levels as small bars
+        float barWidth = (width - (padding * 2)) / (float)NUM_BANDS;
+        float barHeight = 40.0f * uiScale;
+        for (int b = 0; b < NUM_BANDS; b++) {
+            float barX = offsetX + padding + b * barWidth;
+            float level = analysis.bands[b] * barHeight;
+            DrawRectangleRec((Rectangle){ barX + 2.0f, textY + barHeight - level, barWidth - 4.0f, level }, textColor);
+            DrawText(GetBandName(b), (int)barX + 2, (int)(textY + barHeight + 2.0f), (int)(10 * uiScale), textColor);
+        }
+        textY += barHeight + lineHeight;
+
+        // Mel / constant-Q levels as a thin strip
+        if (analysis.filterbankBands > 0) {
+            float stripWidth = (width - (padding * 2)) / (float)analysis.filterbankBands;
+            float stripHeight = 24.0f * uiScale;
+            for (int k = 0; k < analysis.filterbankBands; k++) {
+                float level = analysis.filterbank[k] * stripHeight;
+                DrawRectangleRec((Rectangle){ offsetX + padding + k * stripWidth, textY + stripHeight - level, fmaxf(stripWidth - 1.0f, 1.0f), level }, textColor);
+            }
+            textY += stripHeight + (5.0f * uiScale);
+        }
+
+        // Per-channel bass when the capture is multi-channel
+        if (analysis.channels > 1) {
+            char line[128];
+            int length = snprintf(line, sizeof(line), "Ch Bass:");
+            for (int c = 0; c < analysis.channels; c++) {
+                length += snprintf(line + length, sizeof(line) - length, " %.2f", analysis.channel[c].bass);
+            }
+            snprintf(line + length, sizeof(line) - length, "  Side: %.2f", analysis.side.bass);
+            DrawText(line, (int)(offsetX + padding), (int)textY, fontSize, textColor);
+            textY += lineHeight;
+        }
+
+        // Capture-to-stage latency percentiles
+        for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+            LatencyStats stats = GetLatencyStats(s);
+            DrawText(TextFormat("%s: %.1f / %.1f / %.1f / %.1f ms", GetLatencyStageName(s), stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs),
+                     (int)(offsetX + padding), (int)textY, fontSize, textColor);
+            textY += lineHeight;
+        }
+        DrawText("(p50 / p95 / p99 / max)", (int)(offsetX + padding), (int)textY, (int)(12 * uiScale), textColor);
+        textY += lineHeight;
+
+        float halfWidth = (width - (padding * 2)) / 2.0f;
+        if (DrawCycleButton((Rectangle){ offsetX + padding, textY, halfWidth - 2.0f, rowHeight }, "Dump Latency", uiScale, hueRef)) {
+            DumpLatencyStats(LATENCY_DUMP_FILE);
+        }
+        if (DrawCycleButton((Rectangle){ offsetX + padding + halfWidth + 2.0f, textY, halfWidth - 2.0f, rowHeight }, "Reset Latency", uiScale, hueRef)) {
+            ResetLatencyStats();
+        }
+        textY += rowHeight + (5.0f * uiScale);
+
+        if (DrawCycleButton((Rectangle){ offsetX + padding, textY, halfWidth - 2.0f, rowHeight }, "Dump Health", uiScale, hueRef)) {
+            DumpAudioHealthStats(HEALTH_DUMP_FILE);
+        }
+        if (DrawCycleButton((Rectangle){ offsetX + padding + halfWidth + 2.0f, textY, halfWidth - 2.0f, rowHeight }, "Reset Health", uiScale, hueRef)) {
+            ResetAudioHealthStats();
+        }
+        textY += rowHeight + (5.0f * uiScale);
+
+        // Orb submission cost, to compare the render paths in gravity mode
+        OrbDrawStats orbStats = GetOrbDrawStats();
+        DrawText(TextFormat("Orbs: %i  Verts: %i  Calls: %i  Batches: %i  %.0f us", orbStats.orbs, orbStats.vertices,
+                            orbStats.submissions, orbStats.batches, orbStats.cpuUs),
+                 (int)(offsetX + padding), (int)textY, fontSize, textColor);
+        textY += lineHeight;
+        if (DrawCycleButton((Rectangle){ offsetX + padding, textY, width - (padding * 2), rowHeight },
+                            TextFormat("Orb Render: %s", GetOrbRenderPathName(orbRenderPath)), uiScale, hueRef)) {
+            orbRenderPath = (orbRenderPath + 1) % ORB_RENDER_PATH_COUNT;
+        }
+        textY += rowHeight + (5.0f * uiScale);
+
+        bool recording = IsCaptureRecording();
+        const char* recordText = recording ? TextFormat("Stop Capture (%llu blocks)", (unsigned long long)GetCaptureRecordedBlocks())
+                                           : "Record Capture (" CAPTURE_FILE ")";
+        if (DrawCycleButton((Rectangle){ offsetX + padding, textY, width - (padding * 2), rowHeight }, recordText, uiScale, hueRef)) {
+            if (recording) StopCaptureRecording();
+            else StartCaptureRecording(CAPTURE_FILE);
+        }
+        textY += rowHeight;
+
         offsetY = textY + (10.0f * uiScale); // Update consumed height
     }
 
+    // 3. Analysis Controls (click to cycle)
+    AnalysisSettings settings = GetAnalysisSettings();
+    bool changed = false;
+    offsetY += 10.0f * uiScale;
+    Rectangle rowRect = { offsetX + padding, offsetY, width - (padding * 2), rowHeight };
+
+    if (DrawCycleButton(rowRect, TextFormat("Analysis: %s", GetAnalysisModeName(settings.mode)), uiScale, hueRef)) {
+        settings.mode = (settings.mode + 1) % ANALYSIS_MODE_COUNT;
+        changed = true;
+    }
+    offsetY += rowHeight + (5.0f * uiScale);
+
+    rowRect.y = offsetY;
+    if (DrawCycleButton(rowRect, TextFormat("Auto Gain: %s (ref %.0f)", settings.autoGain ? "On" : "Off", GetLatestAnalysis().bassReference), uiScale, hueRef)) {
+        settings.autoGain = !settings.autoGain;
+        changed = true;
+    }
+    offsetY += rowHeight + (5.0f * uiScale);
+
+    rowRect.y = offsetY;
+    if (DrawCycleButton(rowRect, TextFormat("Filterbank: %s %i", GetFilterbankScaleName(settings.filterbank), settings.filterbankBands), uiScale, hueRef)) {
+        // Off -> Mel 24/48/96 -> Constant-Q 24/48/96 -> Off
+        if (settings.filterbank == FILTERBANK_OFF) {
+            settings.filterbank = FILTERBANK_MEL;
+            settings.filterbankBands = FILTERBANK_MIN_BANDS;
+        } else if (settings.filterbankBands < FILTERBANK_MAX_BANDS) {
+            settings.filterbankBands *= 2;
+        } else {
+            settings.filterbank = (settings.filterbank + 1) % FILTERBANK_SCALE_COUNT;
+            settings.filterbankBands = FILTERBANK_MIN_BANDS;
+        }
+        changed = true;
+    }
+    offsetY += rowHeight + (5.0f * uiScale);
+
+    // Device format: restarts the audio source, analysis follows without a restart
+    int sampleRate, blockFrames;
+    GetActiveAudioFormat(sampleRate, blockFrames);
+    rowRect.y = offsetY;
+    if (DrawCycleButton(rowRect, TextFormat("Sample Rate: %i", sampleRate), uiScale, hueRef)) {
+        RequestAudioFormat(sampleRate == 44100 ? 48000 : 44100, blockFrames);
+    }
+    offsetY += rowHeight + (5.0f * uiScale);
+
+    rowRect.y = offsetY;
+    if (DrawCycleButton(rowRect, TextFormat("Device Block: %i (%.1f ms)", blockFrames, 1000.0f * blockFrames / sampleRate), uiScale, hueRef)) {
+        RequestAudioFormat(sampleRate, blockFrames >= FRAMES_PER_BUFFER ? 64 : blockFrames * 2);
+    }
+    offsetY += rowHeight + (5.0f * uiScale);
+
+    if (settings.mode == ANALYSIS_BLOCK_FFT) {
+        rowRect.y = offsetY;
+        if (DrawCycleButton(rowRect, TextFormat("Block FFT: %i", settings.blockFftSize), uiScale, hueRef)) {
+            settings.blockFftSize = settings.blockFftSize >= 4096 ? 512 : settings.blockFftSize * 2;
+            changed = true;
+        }
+        offsetY += rowHeight + (5.0f * uiScale);
+    }
+
+    if (settings.mode == ANALYSIS_DECIMATED) {
+        rowRect.y = offsetY;
+        if (DrawCycleButton(rowRect, TextFormat("Decimate: /%i (%.1f Hz bins)", settings.decimation,
+                                                (float)sampleRate / settings.decimation / DECIMATE_FFT_SIZE), uiScale, hueRef)) {
+            settings.decimation = (settings.decimation == DECIMATE_MIN_FACTOR) ? DECIMATE_MAX_FACTOR : DECIMATE_MIN_FACTOR;
+            changed = true;
+        }
+        offsetY += rowHeight + (5.0f * uiScale);
+    }
+
+    if (settings.mode == ANALYSIS_STFT) {
+        rowRect.y = offsetY;
+        if (DrawCycleButton(rowRect, TextFormat("FFT Size: %i", settings.stftSize), uiScale, hueRef)) {
+            settings.stftSize = (settings.stftSize == 2048) ? 4096 : 2048;
+            changed = true;
+        }
+        offsetY += rowHeight + (5.0f * uiScale);
+
+        rowRect.y = offsetY;
+        if (DrawCycleButton(rowRect, TextFormat("Hop: %i", settings.stftHop), uiScale, hueRef)) {
+            settings.stftHop = (settings.stftHop == 256) ? 128 : 256;
+            changed = true;
+        }
+        offsetY += rowHeight + (5.0f * uiScale);
+
+        rowRect.y = offsetY;
+        if (DrawCycleButton(rowRect, TextFormat("Window: %s", GetWindowName(settings.stftWindow)), uiScale, hueRef)) {
+            settings.stftWindow = (settings.stftWindow + 1) % WINDOW_TYPE_COUNT;
+            changed = true;
+        }
+        offsetY += rowHeight + (5.0f * uiScale);
+    }
+
+    if (changed) SetAnalysisSettings(settings);
+
     return offsetY - startY;
 }
\ No newline at end of file
@@ -5,7 +5,8 @@
 
 #include "raylib.h"
 
-// Global helper function to convert a hue value to a Color
+// Global helper function to convert a hue value (degrees) to a Color.
+// Thin wrapper over HueToColor (color.h); hue 0 draws DARKGRAY.
 Color GetColorFromHue(int hue);
 
 #endif // GETCOLORFROMHUE_H
@@ -75,7 +75,6 @@ void OrbControl::UpdateOrbSlider() {
         if (orbCount > maxOrbs) orbCount = maxOrbs;
     }
 
-    // Note: this adjusts orbCount only.
-    // If your render/update code does not already recreate `orbs` when orbCount changes,
-    // tell me and I will add a safe resize helper that reallocates the global `orbs` array.
+    // Note: this adjusts orbCount only. UpdateOrbs resizes the orb pool on the next
+    // frame, respawning just the orbs that became active (see gravityorbs.h).
 }
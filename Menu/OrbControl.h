@@ -2,7 +2,7 @@
 #define ORBCONTROL_H
 
 #include "raylib.h"
-#include "./globals.h"   // must declare: extern Orb* orbs; extern int orbCount; extern float hueShift;
+#include "./globals.h"   // must declare: extern int orbCount; extern float hueShift;
 #include <cstdio>
 
 class OrbControl {
@@ -0,0 +1,494 @@
+#include "analysis.h"
+#include "latency.h"
+#include "audiohealth.h"
+#include "capture.h"
+#include "channels.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+// Upper bound on how long a missed wake-up can delay the worker
+#define ANALYSIS_WAIT_MS 2
+
+static const auto clockStart = std::chrono::steady_clock::now();
+
+double AnalysisClockNow() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - clockStart).count();
+}
+
+// =========================================================
+// SETTINGS
+// =========================================================
+
+static std::mutex settingsMutex;
+static AnalysisSettings sharedSettings;
+static std::atomic<uint64_t> sharedSettingsGeneration(1);
+
+const char* GetAnalysisModeName(int mode) {
+    switch (mode) {
+        case ANALYSIS_BLOCK_FFT: return "Block FFT";
+        case ANALYSIS_STFT:      return "STFT";
+        case ANALYSIS_SLIDING_DFT: return "Sliding DFT";
+        case ANALYSIS_DECIMATED: return "Decimated";
+        default:                 return "Unknown";
+    }
+}
+
+void SetAnalysisSettings(const AnalysisSettings& settings) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    sharedSettings = settings;
+    sharedSettingsGeneration.fetch_add(1, std::memory_order_release);
+}
+
+AnalysisSettings GetAnalysisSettings() {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    return sharedSettings;
+}
+
+// =========================================================
+// ANALYZER
+// =========================================================
+
+AudioAnalyzer::AudioAnalyzer()
+    : settingsGeneration(0), sampleRate(DEFAULT_SAMPLE_RATE), blockFrames(0), history(nullptr), historyScale(1.0f), decimatedHistory(nullptr), beatOutput(nullptr), spectrogramOutput(nullptr), lastSpectrum(nullptr), lastSpectrumRate((float)DEFAULT_SAMPLE_RATE)
+{
+    memset(pcm, 0, sizeof(pcm));
+    ResizeBlockFFT(settings.blockFftSize);
+}
+
+AudioAnalyzer::~AudioAnalyzer() {
+    FreeSpectrum(spectrum);
+    FreeAligned(history);
+    FreeSpectrum(decimatedSpectrum);
+    FreeAligned(decimatedHistory);
+}
+
+void AudioAnalyzer::Reset() {
+    snapshot = AnalysisSnapshot();
+    stft.Reset();
+    sdft.Reset();
+    decimator.Reset();
+    beat.Reset();
+    bassGain.Reset(settings.bassNorm);
+    for (int b = 0; b < NUM_BANDS; b++) bandGain[b].Reset(GetBandNormFactor(b));
+    filterbankGain.Reset(BASS_NORM_FACTOR);
+    if (history) memset(history, 0, sizeof(float) * spectrum.fftSize);
+    if (decimatedHistory) memset(decimatedHistory, 0, sizeof(float) * DECIMATE_FFT_SIZE);
+    memset(pcm, 0, sizeof(pcm));
+    lastSpectrum = nullptr;
+}
+
+void AudioAnalyzer::SetFormat(int rate, int frames) {
+    blockFrames = frames;
+    if (rate <= 0) rate = DEFAULT_SAMPLE_RATE;     // AudioBlock::sampleRate 0 means the default, not "unchanged"
+    if (rate == sampleRate) return;
+    sampleRate = rate;
+    ApplySettings(settings);
+}
+
+// Block FFT working set: the spectrum plus a history of the newest `fftSize` samples,
+// pre-scaled by FFT_SIZE / fftSize so BASS_NORM_FACTOR holds at every size.
+bool AudioAnalyzer::ResizeBlockFFT(int fftSize) {
+    if (spectrum.fftSize == fftSize && history) return true;
+
+    FFTSpectrum resized;
+    float* resizedHistory = AllocAlignedFloats(fftSize);
+    if (!resizedHistory || !AllocSpectrum(resized, fftSize)) {
+        FreeAligned(resizedHistory);
+        return false;
+    }
+    memset(resizedHistory, 0, sizeof(float) * fftSize);
+
+    FreeSpectrum(spectrum);
+    FreeAligned(history);
+    spectrum = resized;
+    history = resizedHistory;
+    historyScale = (float)FFT_SIZE / (float)fftSize;
+    return true;
+}
+
+// Decimated mode working set, allocated on first use. History starts silent on every switch.
+bool AudioAnalyzer::ConfigureDecimated(int factor) {
+    if (!decimatedHistory) {
+        decimatedHistory = AllocAlignedFloats(DECIMATE_FFT_SIZE);
+        if (!decimatedHistory || !AllocSpectrum(decimatedSpectrum, DECIMATE_FFT_SIZE)) {
+            FreeAligned(decimatedHistory);
+            decimatedHistory = nullptr;
+            return false;
+        }
+    }
+    memset(decimatedHistory, 0, sizeof(float) * DECIMATE_FFT_SIZE);
+    return decimator.Configure(factor);
+}
+
+// glowMix is defined per FRAMES_PER_BUFFER block at DEFAULT_SAMPLE_RATE. Any other
+// hop length gets the mix with the same decay per second.
+float AudioAnalyzer::GlowMixForHop(int hopFrames) const {
+    float referenceFrames = (float)FRAMES_PER_BUFFER * (float)sampleRate / (float)DEFAULT_SAMPLE_RATE;
+    if (hopFrames <= 0 || (float)hopFrames == referenceFrames) return settings.glowMix;
+    return 1.0f - powf(1.0f - settings.glowMix, (float)hopFrames / referenceFrames);
+}
+
+void AudioAnalyzer::ApplySettings(const AnalysisSettings& newSettings) {
+    // Switching auto gain on starts every tracker from the fixed factors
+    if (newSettings.autoGain && !settings.autoGain) {
+        bassGain.Reset(newSettings.bassNorm);
+        for (int b = 0; b < NUM_BANDS; b++) bandGain[b].Reset(GetBandNormFactor(b));
+        filterbankGain.Reset(BASS_NORM_FACTOR);
+    }
+    settings = newSettings;
+    lastSpectrum = nullptr;
+    if (settings.filterbankBands < FILTERBANK_MIN_BANDS) settings.filterbankBands = FILTERBANK_MIN_BANDS;
+    if (settings.filterbankBands > FILTERBANK_MAX_BANDS) settings.filterbankBands = FILTERBANK_MAX_BANDS;
+    if (settings.mode == ANALYSIS_STFT) {
+        if (!stft.Configure(settings.stftSize, settings.stftHop, settings.stftWindow)) {
+            settings.mode = ANALYSIS_BLOCK_FFT;
+        }
+    } else if (settings.mode == ANALYSIS_SLIDING_DFT) {
+        if (!sdft.Configure(SDFT_SIZE, (float)sampleRate, BASS_LOW_FREQ, BASS_HIGH_FREQ)) {
+            settings.mode = ANALYSIS_BLOCK_FFT;
+        } else {
+            for (int b = 0; b < NUM_BANDS; b++) snapshot.bands[b] = 0.0f;
+            snapshot.filterbankBands = 0;
+        }
+    } else if (settings.mode == ANALYSIS_DECIMATED) {
+        if (!ConfigureDecimated(settings.decimation)) {
+            settings.mode = ANALYSIS_BLOCK_FFT;
+        }
+    }
+    if (settings.mode == ANALYSIS_BLOCK_FFT && !ResizeBlockFFT(settings.blockFftSize)) {
+        settings.blockFftSize = spectrum.fftSize;
+    }
+}
+
+// `spectrumRate` is the rate the spectrum was sampled at; hops and positions stay on the input clock.
+void AudioAnalyzer::AnalyseSpectrum(const FFTSpectrum& spectrum, int hopSize, uint64_t position, float spectrumRate) {
+    lastSpectrum = &spectrum;
+    lastSpectrumRate = spectrumRate;
+    if (bandTable.fftSize != spectrum.fftSize || bandTable.sampleRate != spectrumRate) {
+        BuildBandTable(bandTable, spectrum.fftSize, spectrumRate);
+    }
+    float dt = (float)hopSize / (float)sampleRate;
+    if (settings.autoGain) {
+        float magnitudes[NUM_BANDS];
+        ComputeBandMagnitudes(spectrum, bandTable, magnitudes);
+        for (int b = 0; b < NUM_BANDS; b++) {
+            snapshot.bands[b] = bandGain[b].Process(magnitudes[b], dt, settings.gainPercentile, settings.gainAttack, settings.gainRelease);
+        }
+    } else {
+        ComputeBands(spectrum, bandTable, snapshot.bands);
+    }
+    UpdateFilterbank(spectrum, spectrumRate, dt);
+    if (spectrogramOutput) spectrogramOutput->PushColumn(spectrum.magnitude, spectrum.bins, spectrumRate / (float)spectrum.fftSize);
+
+    if (beat.GetBins() != spectrum.bins || beat.GetHopSize() != hopSize || beat.GetSampleRate() != (float)sampleRate ||
+        beat.GetSpectrumRate() != spectrumRate) {
+        beat.Configure(spectrum.bins, hopSize, (float)sampleRate, spectrumRate);
+    }
+    BeatEvent event;
+    if (beat.Process(spectrum.magnitude, position, event)) {
+        snapshot.beatCount++;
+        snapshot.lastBeatSample = event.samplePosition;
+        if (beatOutput) beatOutput->Push(event);
+    }
+    snapshot.onset = beat.GetOnset();
+    snapshot.bpm = beat.GetBPM();
+    snapshot.beatPhase = beat.GetPhase(position);
+
+    float bassMagnitude = ComputeBassMagnitude(spectrum, spectrumRate);
+    float boostedBass = BoostBassLevel(bassMagnitude, BassReference(bassMagnitude, dt), settings.bassBoost);
+
+    UpdateGlow(boostedBass, GlowMixForHop(hopSize));
+}
+
+// Filterbank levels, normalised by BASS_NORM_FACTOR or by one adaptive reference that
+// tracks the loudest band (per-band gains would flatten the spectrum visuals map to hue).
+void AudioAnalyzer::UpdateFilterbank(const FFTSpectrum& spectrum, float spectrumRate, float dt) {
+    if (filterbank.scale != settings.filterbank || filterbank.fftSize != spectrum.fftSize ||
+        filterbank.sampleRate != spectrumRate ||
+        (filterbank.bands != 0 && filterbank.bands != settings.filterbankBands)) {
+        BuildFilterbank(filterbank, settings.filterbank, settings.filterbankBands, spectrum.fftSize, spectrumRate);
+    }
+    snapshot.filterbankBands = filterbank.bands;
+    if (filterbank.bands == 0) return;
+
+    ApplyFilterbank(filterbank, spectrum.magnitude, snapshot.filterbank);
+
+    float reference = BASS_NORM_FACTOR;
+    if (settings.autoGain) {
+        float loudest = 0.0f;
+        for (int k = 0; k < filterbank.bands; k++) loudest = fmaxf(loudest, snapshot.filterbank[k]);
+        filterbankGain.Process(loudest, dt, settings.gainPercentile, settings.gainAttack, settings.gainRelease);
+        reference = filterbankGain.GetReference();
+    }
+    float scale = 1.0f / reference;
+    for (int k = 0; k < filterbank.bands; k++) {
+        snapshot.filterbank[k] = fminf(snapshot.filterbank[k] * scale, 1.0f);
+    }
+}
+
+// Fixed bassNorm, or the adaptive reference after folding this magnitude in.
+float AudioAnalyzer::BassReference(float magnitude, float dt) {
+    if (settings.autoGain) {
+        bassGain.Process(magnitude, dt, settings.gainPercentile, settings.gainAttack, settings.gainRelease);
+        snapshot.bassReference = bassGain.GetReference();
+    } else {
+        snapshot.bassReference = settings.bassNorm;
+    }
+    return snapshot.bassReference;
+}
+
+void AudioAnalyzer::UpdateGlow(float boostedBass, float glowMix) {
+    // --- GLOBAL PUMP APPLICATION ---
+    float pumpedBass = boostedBass * settings.pump;
+    snapshot.glow = snapshot.glow * (1.0f - glowMix) + pumpedBass * glowMix;
+    snapshot.bass = boostedBass;
+    snapshot.frames++;
+}
+
+// Shift `count` new samples into the end of `buffer` (length `size`), scaled by `scale`.
+static void AppendHistory(float* buffer, int size, const float* samples, int count, float scale) {
+    if (count >= size) {
+        for (int i = 0; i < size; i++) buffer[i] = samples[count - size + i] * scale;
+        return;
+    }
+    memmove(buffer, buffer + count, sizeof(float) * (size - count));
+    for (int i = 0; i < count; i++) buffer[size - count + i] = samples[i] * scale;
+}
+
+const AnalysisSnapshot& AudioAnalyzer::ProcessBlock(const AudioBlock& block) {
+    SetFormat(block.sampleRate, block.blockFrames);
+    ProcessSamples(block.samples, block.frames);
+    snapshot.sequence = block.sequence;
+    snapshot.captureTime = block.captureTime;
+    return snapshot;
+}
+
+const AnalysisSnapshot& AudioAnalyzer::ProcessSamples(const float* samples, unsigned long frames) {
+    uint64_t generation = sharedSettingsGeneration.load(std::memory_order_acquire);
+    if (generation != settingsGeneration) {
+        settingsGeneration = generation;
+        ApplySettings(GetAnalysisSettings());
+    }
+
+    uint64_t blockStart = snapshot.samplePosition;
+    snapshot.samplePosition += frames;
+
+    if (settings.mode == ANALYSIS_STFT) {
+        int count = (int)frames;
+        int offset = 0;
+        while (offset < count) {
+            offset += stft.Feed(samples + offset, count - offset);
+            if (stft.HopReady()) {
+                stft.Transform();
+                AnalyseSpectrum(stft.GetSpectrum(), stft.GetHopSize(), blockStart + (uint64_t)offset, (float)sampleRate);
+            }
+        }
+    } else if (settings.mode == ANALYSIS_SLIDING_DFT) {
+        sdft.Process(samples, (int)frames);
+        float bassMagnitude = sdft.GetMeanMagnitude();
+        float reference = BassReference(bassMagnitude, (float)frames / (float)sampleRate);
+        UpdateGlow(BoostBassLevel(bassMagnitude, reference, settings.bassBoost), GlowMixForHop((int)frames));
+    } else if (settings.mode == ANALYSIS_DECIMATED && frames > 0) {
+        // Unwindowed like the block FFT, pre-scaled to the FFT_SIZE reference
+        int count = decimator.Process(samples, (int)frames, decimated);
+        AppendHistory(decimatedHistory, DECIMATE_FFT_SIZE, decimated, count, (float)FFT_SIZE / (float)DECIMATE_FFT_SIZE);
+        ComputeSpectrum(decimatedSpectrum, decimatedHistory, DECIMATE_FFT_SIZE);
+        AnalyseSpectrum(decimatedSpectrum, blockFrames > 0 ? blockFrames : (int)frames, snapshot.samplePosition,
+                        (float)sampleRate / (float)decimator.GetFactor());
+    } else if (frames > 0) {
+        AppendHistory(history, spectrum.fftSize, samples, (int)frames, historyScale);
+        ComputeSpectrum(spectrum, history, spectrum.fftSize);
+        AnalyseSpectrum(spectrum, blockFrames > 0 ? blockFrames : (int)frames, snapshot.samplePosition, (float)sampleRate);
+    }
+
+    snapshot.blocks++;
+    AppendHistory(pcm, FRAMES_PER_BUFFER, samples, (int)frames, 1.0f);
+    return snapshot;
+}
+
+// =========================================================
+// MULTI-CHANNEL ANALYZER
+// =========================================================
+
+static void CopyChannelLevels(const AnalysisSnapshot& source, ChannelLevels& levels) {
+    levels.bass = source.bass;
+    levels.glow = source.glow;
+    levels.onset = source.onset;
+    for (int b = 0; b < NUM_BANDS; b++) levels.bands[b] = source.bands[b];
+}
+
+MultiChannelAnalyzer::MultiChannelAnalyzer() {
+    sidePlane = AllocAlignedFloats(FRAMES_PER_BUFFER);
+}
+
+MultiChannelAnalyzer::~MultiChannelAnalyzer() {
+    FreeAligned(sidePlane);
+}
+
+const AnalysisSnapshot& MultiChannelAnalyzer::ProcessBlock(const AudioBlock& block) {
+    snapshot = mix.ProcessBlock(block);
+    snapshot.channels = block.channels > 1 ? block.channels : 1;
+
+    if (snapshot.channels == 1) {
+        CopyChannelLevels(snapshot, snapshot.channel[0]);
+        snapshot.side = ChannelLevels();
+        return snapshot;
+    }
+
+    for (int c = 0; c < snapshot.channels; c++) channelAnalyzers[c].SetFormat(block.sampleRate, block.blockFrames);
+    sideAnalyzer.SetFormat(block.sampleRate, block.blockFrames);
+    for (int c = 0; c < snapshot.channels; c++) {
+        CopyChannelLevels(channelAnalyzers[c].ProcessSamples(block.planes[c], block.frames), snapshot.channel[c]);
+    }
+    if (sidePlane) {
+        ComputeSidePlane(block, sidePlane);
+        CopyChannelLevels(sideAnalyzer.ProcessSamples(sidePlane, block.frames), snapshot.side);
+    }
+    return snapshot;
+}
+
+// =========================================================
+// ANALYSIS THREAD
+// =========================================================
+
+static std::thread analysisThread;
+static std::atomic<bool> analysisRunning(false);
+static std::mutex wakeMutex;
+static std::condition_variable wakeCondition;
+
+static std::mutex snapshotMutex;
+static AnalysisSnapshot latestSnapshot;
+
+static TripleBuffer<VisualFrame> visualFrames;
+
+static std::atomic<LightOutputFn> lightOutput(nullptr);
+static std::atomic<float> lightFloor(0.0f);
+static std::atomic<float> lightHue(0.0f);
+
+BeatRing gBeatRing;
+SpectrogramRing gSpectrogram;
+
+static void PublishSnapshot(const AnalysisSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    latestSnapshot = snapshot;
+    latestSnapshot.timestamp = AnalysisClockNow();
+}
+
+static void PublishVisualFrame(const MultiChannelAnalyzer& analyzer) {
+    const AudioAnalyzer& mix = analyzer.GetMixAnalyzer();
+    const AnalysisSnapshot& snapshot = analyzer.GetSnapshot();
+    VisualFrame& frame = visualFrames.GetWriteBuffer();
+
+    frame.blocks = snapshot.blocks;
+    frame.captureTime = snapshot.captureTime;
+    frame.glow = snapshot.glow;
+    frame.bass = snapshot.bass;
+    frame.onset = snapshot.onset;
+    frame.bpm = snapshot.bpm;
+    frame.beatPhase = snapshot.beatPhase;
+    memcpy(frame.bands, snapshot.bands, sizeof(frame.bands));
+    frame.filterbankBands = snapshot.filterbankBands;
+    memcpy(frame.filterbank, snapshot.filterbank, sizeof(float) * snapshot.filterbankBands);
+    frame.sampleRate = mix.GetSampleRate();
+    memcpy(frame.pcm, mix.GetPCM(), sizeof(frame.pcm));
+
+    const FFTSpectrum* spectrum = mix.GetLastSpectrum();
+    if (spectrum && spectrum->magnitude) {
+        frame.spectrumRate = mix.GetLastSpectrumRate();
+        frame.fftSize = spectrum->fftSize;
+        frame.spectrumBins = std::min(spectrum->bins, VISUAL_MAX_BINS);
+        memcpy(frame.spectrum, spectrum->magnitude, sizeof(float) * frame.spectrumBins);
+    } else {
+        frame.fftSize = 0;
+        frame.spectrumBins = 0;
+    }
+
+    visualFrames.Publish();
+}
+
+static void AnalysisThreadMain() {
+    MultiChannelAnalyzer analyzer;
+    analyzer.SetBeatOutput(&gBeatRing);
+    analyzer.SetSpectrogramOutput(&gSpectrogram);
+
+    while (analysisRunning.load(std::memory_order_acquire)) {
+        // At most one ring's worth per pass so a producer that keeps the ring busy
+        // (an unthrottled source) cannot starve snapshot publishing.
+        int analysed = 0;
+        while (analysed < AUDIO_RING_BLOCKS) {
+            const AudioBlock* block = gAudioRing.BeginRead();
+            if (!block) break;
+            RecordLatency(LATENCY_QUEUED, AnalysisClockNow() - block->captureTime);
+            RecordAnalysedSequence(block->sequence);
+            analyzer.ProcessBlock(*block);
+            RecordLatency(LATENCY_ANALYSED, AnalysisClockNow() - block->captureTime);
+            if (IsCaptureRecording()) {
+                const AudioAnalyzer& mix = analyzer.GetMixAnalyzer();
+                CaptureAnalysedBlock(*block, analyzer.GetSnapshot(), mix.GetSettings(), mix.GetSettingsGeneration());
+            }
+            gAudioRing.EndRead();
+            analysed++;
+        }
+
+        if (analysed > 0) {
+            const AnalysisSnapshot& snapshot = analyzer.GetSnapshot();
+            PublishSnapshot(snapshot);
+            PublishVisualFrame(analyzer);
+
+            // Light output follows the audio clock, not the frame clock
+            LightOutputFn output = lightOutput.load(std::memory_order_acquire);
+            if (output) {
+                float floor = lightFloor.load(std::memory_order_relaxed);
+                float hue = lightHue.load(std::memory_order_relaxed);
+                float finalBrightness = floor + (snapshot.glow * (1.0f - floor));
+                output(finalBrightness, hue / 360.0f);
+                RecordLatency(LATENCY_SENT, AnalysisClockNow() - snapshot.captureTime);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait_for(lock, std::chrono::milliseconds(ANALYSIS_WAIT_MS), [] {
+            return !gAudioRing.Empty() || !analysisRunning.load(std::memory_order_acquire);
+        });
+    }
+}
+
+void StartAnalysisThread() {
+    if (analysisRunning.exchange(true)) return;
+    analysisThread = std::thread(AnalysisThreadMain);
+}
+
+void StopAnalysisThread() {
+    if (!analysisRunning.exchange(false)) return;
+    wakeCondition.notify_one();
+    if (analysisThread.joinable()) analysisThread.join();
+}
+
+void NotifyAnalysisThread() {
+    // No lock: a wake-up racing the wait predicate is caught by the ANALYSIS_WAIT_MS timeout
+    wakeCondition.notify_one();
+}
+
+void SetLightOutput(LightOutputFn output) {
+    lightOutput.store(output, std::memory_order_release);
+}
+
+void SetLightOutputLevels(float floor, float hue) {
+    lightFloor.store(floor, std::memory_order_relaxed);
+    lightHue.store(hue, std::memory_order_relaxed);
+}
+
+AnalysisSnapshot GetLatestAnalysis() {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return latestSnapshot;
+}
+
+const VisualFrame& AcquireVisualFrame() {
+    return visualFrames.Acquire();
+}
@@ -0,0 +1,291 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <cstdint>
+#include "globals.h"
+#include "audioring.h"
+#include "fft.h"
+#include "stft.h"
+#include "bands.h"
+#include "filterbank.h"
+#include "slidingdft.h"
+#include "decimator.h"
+#include "beat.h"
+#include "autogain.h"
+#include "spectrogram.h"
+#include "triplebuffer.h"
+#include "floatspan.h"
+#include <cstddef>
+
+#define GLOW_MIX            0.275f
+
+// =========================================================
+// SETTINGS
+// =========================================================
+
+enum AnalysisMode {
+    ANALYSIS_BLOCK_FFT,     // One unwindowed FFT of the newest blockFftSize samples per block
+    ANALYSIS_STFT,          // Overlapping windowed STFT, one result per hop
+    ANALYSIS_SLIDING_DFT,   // Per-sample sliding DFT of the bass bins only (no spectrum, no bands)
+    ANALYSIS_DECIMATED,     // Polyphase low-pass + downsample, then a DECIMATE_FFT_SIZE FFT per block
+                            // (fine bass bins; bands only up to the decimated Nyquist)
+    ANALYSIS_MODE_COUNT
+};
+
+const char* GetAnalysisModeName(int mode);
+
+struct AnalysisSettings {
+    int mode = ANALYSIS_BLOCK_FFT;
+    int stftSize = STFT_DEFAULT_SIZE;
+    int stftHop = STFT_DEFAULT_HOP;
+    int stftWindow = WINDOW_HANN;
+    int blockFftSize = FFT_SIZE;        // Block FFT mode analysis size (even, any length)
+
+    // Level mapping (defaults are the hand-tuned constants)
+    float bassNorm = BASS_NORM_FACTOR;
+    float bassBoost = BASS_BOOST_EXPONENT;
+    float glowMix = GLOW_MIX;
+    float pump = 1.0f;                  // Glow multiplier (the menu's global pump)
+
+    // Adaptive gain: when on, bass and every band are normalised by a running
+    // percentile of their own level instead of bassNorm / BASS_NORM_FACTOR.
+    bool autoGain = false;
+    float gainPercentile = AUTOGAIN_DEFAULT_PERCENTILE;
+    float gainAttack = AUTOGAIN_DEFAULT_ATTACK_SEC;
+    float gainRelease = AUTOGAIN_DEFAULT_RELEASE_SEC;
+
+    // Mel / constant-Q bands next to the linear spectrum (see filterbank.h)
+    int filterbank = FILTERBANK_MEL;
+    int filterbankBands = FILTERBANK_DEFAULT_BANDS;
+
+    // Decimated mode downsampling factor (DECIMATE_MIN_FACTOR..DECIMATE_MAX_FACTOR)
+    int decimation = DECIMATE_DEFAULT_FACTOR;
+};
+
+// Thread safe; the analyzer picks changes up at the start of its next block.
+void SetAnalysisSettings(const AnalysisSettings& settings);
+AnalysisSettings GetAnalysisSettings();
+
+// =========================================================
+// ANALYSIS SNAPSHOT
+// =========================================================
+// Everything the render side needs from one analysed audio block.
+
+// Levels of one channel (or the side signal) in a multi-channel capture.
+struct ChannelLevels {
+    float bass = 0.0f;
+    float glow = 0.0f;
+    float onset = 0.0f;
+    float bands[NUM_BANDS] = {};
+};
+
+struct AnalysisSnapshot {
+    uint64_t sequence = 0;      // Sequence of the last block folded into this snapshot
+    double captureTime = 0.0;   // captureTime of that block (see latency.h)
+    uint64_t blocks = 0;        // Blocks analysed since the thread started
+    uint64_t frames = 0;        // Spectra computed (one per block, or one per STFT hop)
+    double timestamp = 0.0;     // AnalysisClockNow() when published
+    float bass = 0.0f;          // Boosted bass level of the last block (0..1)
+    float bassReference = BASS_NORM_FACTOR;     // Magnitude that maps to bass 1.0 (fixed or adaptive)
+    float glow = 0.0f;          // glowMix smoothed, pumped glow
+    float bands[NUM_BANDS] = {};        // Per-band level of the last spectrum (0..1), see bands.h
+    uint64_t samplePosition = 0;        // Input samples analysed so far
+    float onset = 0.0f;                 // Onset strength of the last hop
+    float bpm = 0.0f;                   // Tempo estimate (0 until known)
+    float beatPhase = 0.0f;             // 0 on a beat, rising towards 1 before the next
+    uint64_t beatCount = 0;             // Beats fired so far
+    uint64_t lastBeatSample = 0;        // samplePosition of the last beat
+    int filterbankBands = 0;            // Valid entries of `filterbank` (0 when off or in sliding DFT mode)
+    float filterbank[FILTERBANK_MAX_BANDS] = {};    // Mel / constant-Q level per band (0..1)
+
+    // Multi-channel capture. The fields above describe the mono mix (mid for stereo);
+    // with channels == 1 channel[0] mirrors them and `side` stays silent.
+    int channels = 1;
+    ChannelLevels channel[MAX_AUDIO_CHANNELS];
+    ChannelLevels side;                 // (channel 0 - channel 1) / 2
+};
+
+// Seconds on a monotonic clock shared by every analysis timestamp.
+double AnalysisClockNow();
+
+// =========================================================
+// ANALYZER (thread agnostic)
+// =========================================================
+
+class AudioAnalyzer {
+public:
+    AudioAnalyzer();
+    ~AudioAnalyzer();
+
+    void Reset();
+
+    // FFT + glow smoothing for one block of the mono mix. Returns the updated snapshot.
+    const AnalysisSnapshot& ProcessBlock(const AudioBlock& block);
+
+    // Same for a bare sample plane (one channel of a block). Leaves sequence / captureTime alone.
+    const AnalysisSnapshot& ProcessSamples(const float* samples, unsigned long frames);
+
+    // ProcessBlock follows each block's sampleRate / blockFrames; bare planes use the last
+    // ones set. Block FFT mode hops by blockFrames so a short final block cannot retune
+    // the beat tracker (0 = hop by each block's frame count). A sampleRate of 0 is
+    // DEFAULT_SAMPLE_RATE, as in AudioBlock.
+    void SetFormat(int sampleRate, int blockFrames);
+    int GetSampleRate() const { return sampleRate; }
+    const AnalysisSnapshot& GetSnapshot() const { return snapshot; }
+
+    // Settings in effect for the last block (clamped) and the generation they were picked up from.
+    const AnalysisSettings& GetSettings() const { return settings; }
+    uint64_t GetSettingsGeneration() const { return settingsGeneration; }
+
+    // Newest FRAMES_PER_BUFFER input samples, oldest first.
+    const float* GetPCM() const { return pcm; }
+
+    // Spectrum of the last analysed hop (nullptr in sliding DFT mode or before the first one)
+    // and the rate it was sampled at (sampleRate / decimation in decimated mode).
+    const FFTSpectrum* GetLastSpectrum() const { return lastSpectrum; }
+    float GetLastSpectrumRate() const { return lastSpectrumRate; }
+
+    // Beat events are pushed here as they fire (nullptr to discard them).
+    void SetBeatOutput(BeatRing* ring) { beatOutput = ring; }
+
+    // Every analysed spectrum is quantized into this ring as one column (nullptr = off).
+    void SetSpectrogramOutput(SpectrogramRing* ring) { spectrogramOutput = ring; }
+
+private:
+    void ApplySettings(const AnalysisSettings& newSettings);
+    bool ResizeBlockFFT(int fftSize);
+    bool ConfigureDecimated(int factor);
+    float GlowMixForHop(int hopFrames) const;
+    void AnalyseSpectrum(const FFTSpectrum& spectrum, int hopSize, uint64_t position, float spectrumRate);
+    void UpdateFilterbank(const FFTSpectrum& spectrum, float spectrumRate, float dt);
+    void UpdateGlow(float boostedBass, float glowMix);
+    float BassReference(float magnitude, float dt);
+
+    AnalysisSettings settings;
+    uint64_t settingsGeneration;
+    int sampleRate;
+    int blockFrames;
+    FFTSpectrum spectrum;   // Block FFT mode
+    float* history;         // Newest spectrum.fftSize samples, pre-scaled by historyScale
+    float historyScale;
+    STFTAnalyzer stft;
+    SlidingDFT sdft;
+    Decimator decimator;
+    FFTSpectrum decimatedSpectrum;  // Decimated mode
+    float* decimatedHistory;        // Newest DECIMATE_FFT_SIZE decimated samples, pre-scaled
+    float decimated[FRAMES_PER_BUFFER / DECIMATE_MIN_FACTOR + 1];
+    BandTable bandTable;
+    Filterbank filterbank;
+    BeatTracker beat;
+    AutoGain bassGain;
+    AutoGain bandGain[NUM_BANDS];
+    AutoGain filterbankGain;    // Shared by every filterbank band so the spectral shape survives
+    BeatRing* beatOutput;
+    SpectrogramRing* spectrogramOutput;
+    const FFTSpectrum* lastSpectrum;
+    float lastSpectrumRate;
+    AnalysisSnapshot snapshot;
+    float pcm[FRAMES_PER_BUFFER];
+};
+
+// =========================================================
+// MULTI-CHANNEL ANALYZER
+// =========================================================
+// The mono mix drives glow, beats and the light packet exactly as before. Each
+// captured channel and the stereo side signal get their own AudioAnalyzer, so the
+// per-block cost grows linearly with channels and mono capture costs nothing extra.
+
+class MultiChannelAnalyzer {
+public:
+    MultiChannelAnalyzer();
+    ~MultiChannelAnalyzer();
+
+    const AnalysisSnapshot& ProcessBlock(const AudioBlock& block);
+    const AnalysisSnapshot& GetSnapshot() const { return snapshot; }
+
+    // Beat events of the mono mix only.
+    void SetBeatOutput(BeatRing* ring) { mix.SetBeatOutput(ring); }
+
+    // Spectrogram of the mono mix only.
+    void SetSpectrogramOutput(SpectrogramRing* ring) { mix.SetSpectrogramOutput(ring); }
+
+    // Analyzer of the mono mix (PCM history and spectrum for visualizers).
+    const AudioAnalyzer& GetMixAnalyzer() const { return mix; }
+
+private:
+    AudioAnalyzer mix;
+    AudioAnalyzer channelAnalyzers[MAX_AUDIO_CHANNELS];
+    AudioAnalyzer sideAnalyzer;
+    float* sidePlane;
+    AnalysisSnapshot snapshot;
+};
+
+// =========================================================
+// ANALYSIS THREAD
+// =========================================================
+// Drains gAudioRing as soon as blocks arrive, analyses them and sends the light
+// packet (when an output is set), independent of the render loop's frame pacing.
+
+void StartAnalysisThread();
+void StopAnalysisThread();
+
+// Wake the analysis thread. Safe to call from the audio callback (never blocks).
+void NotifyAnalysisThread();
+
+// Copy of the most recently published snapshot.
+AnalysisSnapshot GetLatestAnalysis();
+
+// Where the analysis thread sends the light packet: brightness and hue, both 0..1.
+// None by default, so --headless and --analyze never touch the network; the windowed
+// app installs SendToPython once winsock is up. Pass nullptr to turn it off again.
+typedef void (*LightOutputFn)(float brightness, float hue);
+void SetLightOutput(LightOutputFn output);
+
+// Brightness floor (0..1) and hue (degrees) of the light output. The render thread
+// owns both; the analysis thread reads each once per pass.
+void SetLightOutputLevels(float floor, float hue);
+
+// =========================================================
+// VISUAL FRAME
+// =========================================================
+// Everything a visualizer draws from, published by the analysis thread through a
+// TripleBuffer. The render thread reads it in place: no lock, no copy of the
+// audio data and no heap allocation per frame.
+
+// Spectra up to 4096 points are kept whole; larger ones are truncated.
+#define VISUAL_MAX_BINS (4096 / 2 + 1)
+
+struct VisualFrame {
+    uint64_t blocks = 0;            // AnalysisSnapshot::blocks when published (0 = nothing yet)
+    double captureTime = 0.0;
+    float glow = 0.0f;
+    float bass = 0.0f;
+    float onset = 0.0f;
+    float bpm = 0.0f;
+    float beatPhase = 0.0f;
+    float bands[NUM_BANDS] = {};
+    int filterbankBands = 0;
+    float filterbank[FILTERBANK_MAX_BANDS] = {};
+    int sampleRate = DEFAULT_SAMPLE_RATE;
+    float spectrumRate = DEFAULT_SAMPLE_RATE;   // Bin spacing is spectrumRate / fftSize
+    int fftSize = 0;                // 0 when the mode has no spectrum (sliding DFT)
+    int spectrumBins = 0;
+    float pcm[FRAMES_PER_BUFFER] = {};      // Newest samples of the mono mix, oldest first
+    float spectrum[VISUAL_MAX_BINS] = {};   // Magnitudes of the last spectrum
+
+    FloatSpan GetPCM() const { return { pcm, (size_t)FRAMES_PER_BUFFER }; }
+    FloatSpan GetSpectrum() const { return { spectrum, (size_t)spectrumBins }; }
+    FloatSpan GetBands() const { return { bands, (size_t)NUM_BANDS }; }
+    FloatSpan GetFilterbank() const { return { filterbank, (size_t)filterbankBands }; }
+};
+
+// Newest published frame (render thread only). Stays valid until the next call.
+const VisualFrame& AcquireVisualFrame();
+
+// Beat events from the analysis thread, consumed by the render thread.
+extern BeatRing gBeatRing;
+
+// Spectrogram history of the mono mix, written by the analysis thread.
+extern SpectrogramRing gSpectrogram;
+
+#endif // ANALYSIS_H
@@ -0,0 +1,194 @@
+#include "audiohealth.h"
+#include "audioring.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+// Single writer per group, so plain load/store pairs are enough throughout. A reset
+// only bumps resetRequest; each writer clears its own group when it next records, so
+// no counter ever has a second writer.
+struct AudioHealthCounters {
+    std::atomic<uint32_t> resetRequest;
+
+    // Audio callback
+    std::atomic<uint64_t> callbacks;
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> inputOverflows;
+    std::atomic<uint64_t> inputUnderflows;
+    std::atomic<uint64_t> lateCallbacks;
+    std::atomic<uint64_t> intervals;
+    std::atomic<double> lastStart;
+    std::atomic<double> blockPeriod;
+    std::atomic<double> intervalSum;
+    std::atomic<double> intervalMax;
+    std::atomic<double> deviationSqSum;
+    std::atomic<double> durationSum;
+    std::atomic<double> durationMax;
+    std::atomic<uint64_t> overrunBase;
+    std::atomic<uint32_t> callbackReset;    // resetRequest last applied to this group
+
+    // Analysis thread
+    std::atomic<uint64_t> droppedBlocks;
+    std::atomic<uint64_t> nextSequence;
+    std::atomic<bool> sequenceValid;
+    std::atomic<uint32_t> sequenceReset;
+
+    // Source owner
+    std::atomic<float> cpuLoad;
+    std::atomic<float> cpuLoadMax;
+    std::atomic<uint32_t> cpuLoadReset;
+};
+
+static AudioHealthCounters health;
+
+static void Add(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+static void Add(std::atomic<double>& sum, double amount) {
+    sum.store(sum.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+template <typename T>
+static void Max(std::atomic<T>& current, T value) {
+    if (value > current.load(std::memory_order_relaxed)) current.store(value, std::memory_order_relaxed);
+}
+
+// True (once) when a reset was requested since this group last applied one
+static bool TakeReset(std::atomic<uint32_t>& applied) {
+    uint32_t request = health.resetRequest.load(std::memory_order_acquire);
+    if (request == applied.load(std::memory_order_relaxed)) return false;
+    applied.store(request, std::memory_order_release);
+    return true;
+}
+
+// Readers show a group as cleared from the request on, not from the writer's pickup
+static bool ResetPending(const std::atomic<uint32_t>& applied) {
+    return health.resetRequest.load(std::memory_order_acquire) != applied.load(std::memory_order_acquire);
+}
+
+void RecordAudioCallback(unsigned long frames, double period, bool inputOverflow, bool inputUnderflow,
+                         double startTime, double endTime) {
+    if (TakeReset(health.callbackReset)) {
+        health.callbacks.store(0, std::memory_order_relaxed);
+        health.frames.store(0, std::memory_order_relaxed);
+        health.inputOverflows.store(0, std::memory_order_relaxed);
+        health.inputUnderflows.store(0, std::memory_order_relaxed);
+        health.lateCallbacks.store(0, std::memory_order_relaxed);
+        health.intervals.store(0, std::memory_order_relaxed);
+        health.lastStart.store(0.0, std::memory_order_relaxed);
+        health.intervalSum.store(0.0, std::memory_order_relaxed);
+        health.intervalMax.store(0.0, std::memory_order_relaxed);
+        health.deviationSqSum.store(0.0, std::memory_order_relaxed);
+        health.durationSum.store(0.0, std::memory_order_relaxed);
+        health.durationMax.store(0.0, std::memory_order_relaxed);
+        // The callback is also the ring's producer, so the overrun count is its own
+        health.overrunBase.store(gAudioRing.Overruns(), std::memory_order_relaxed);
+    }
+
+    Add(health.callbacks, 1);
+    Add(health.frames, frames);
+    if (inputOverflow) Add(health.inputOverflows, 1);
+    if (inputUnderflow) Add(health.inputUnderflows, 1);
+
+    double duration = endTime - startTime;
+    Add(health.durationSum, duration);
+    Max(health.durationMax, duration);
+
+    // Interval to the previous callback against the nominal block period
+    double lastStart = health.lastStart.exchange(startTime, std::memory_order_relaxed);
+    health.blockPeriod.store(period, std::memory_order_relaxed);
+    if (lastStart <= 0.0 || period <= 0.0) return;
+
+    double interval = startTime - lastStart;
+    double deviation = interval - period;
+    Add(health.intervals, 1);
+    Add(health.intervalSum, interval);
+    Add(health.deviationSqSum, deviation * deviation);
+    Max(health.intervalMax, interval);
+    if (interval > HEALTH_LATE_FACTOR * period) Add(health.lateCallbacks, 1);
+}
+
+void RecordAnalysedSequence(uint64_t sequence) {
+    if (TakeReset(health.sequenceReset)) {
+        health.droppedBlocks.store(0, std::memory_order_relaxed);
+        health.nextSequence.store(0, std::memory_order_relaxed);
+        health.sequenceValid.store(false, std::memory_order_relaxed);
+    }
+
+    uint64_t expected = health.nextSequence.load(std::memory_order_relaxed);
+    if (health.sequenceValid.load(std::memory_order_relaxed) && sequence > expected) {
+        Add(health.droppedBlocks, sequence - expected);
+    }
+    health.nextSequence.store(sequence + 1, std::memory_order_relaxed);
+    health.sequenceValid.store(true, std::memory_order_relaxed);
+}
+
+void RecordAudioCpuLoad(float load) {
+    if (TakeReset(health.cpuLoadReset)) health.cpuLoadMax.store(0.0f, std::memory_order_relaxed);
+    health.cpuLoad.store(load, std::memory_order_relaxed);
+    Max(health.cpuLoadMax, load);
+}
+
+AudioHealthStats GetAudioHealthStats() {
+    AudioHealthStats stats;
+    stats.blockPeriodMs = (float)(health.blockPeriod.load(std::memory_order_relaxed) * 1000.0);
+
+    if (!ResetPending(health.callbackReset)) {
+        stats.callbacks = health.callbacks.load(std::memory_order_relaxed);
+        stats.frames = health.frames.load(std::memory_order_relaxed);
+        stats.inputOverflows = health.inputOverflows.load(std::memory_order_relaxed);
+        stats.inputUnderflows = health.inputUnderflows.load(std::memory_order_relaxed);
+        stats.ringOverruns = gAudioRing.Overruns() - health.overrunBase.load(std::memory_order_relaxed);
+        stats.lateCallbacks = health.lateCallbacks.load(std::memory_order_relaxed);
+
+        uint64_t intervals = health.intervals.load(std::memory_order_relaxed);
+        if (intervals > 0) {
+            stats.intervalMeanMs = (float)(health.intervalSum.load(std::memory_order_relaxed) / intervals * 1000.0);
+            stats.jitterRmsMs = (float)(sqrt(health.deviationSqSum.load(std::memory_order_relaxed) / intervals) * 1000.0);
+        }
+        stats.intervalMaxMs = (float)(health.intervalMax.load(std::memory_order_relaxed) * 1000.0);
+        if (stats.callbacks > 0) {
+            stats.callbackMeanUs = (float)(health.durationSum.load(std::memory_order_relaxed) / stats.callbacks * 1e6);
+        }
+        stats.callbackMaxUs = (float)(health.durationMax.load(std::memory_order_relaxed) * 1e6);
+    }
+    if (!ResetPending(health.sequenceReset)) {
+        stats.droppedBlocks = health.droppedBlocks.load(std::memory_order_relaxed);
+    }
+    if (!ResetPending(health.cpuLoadReset)) {
+        stats.cpuLoad = health.cpuLoad.load(std::memory_order_relaxed);
+        stats.cpuLoadMax = health.cpuLoadMax.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void ResetAudioHealthStats() {
+    health.resetRequest.fetch_add(1, std::memory_order_release);
+}
+
+bool DumpAudioHealthStats(const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+
+    AudioHealthStats stats = GetAudioHealthStats();
+    fprintf(out, "metric,value\n");
+    fprintf(out, "callbacks,%llu\n", (unsigned long long)stats.callbacks);
+    fprintf(out, "frames,%llu\n", (unsigned long long)stats.frames);
+    fprintf(out, "input_overflows,%llu\n", (unsigned long long)stats.inputOverflows);
+    fprintf(out, "input_underflows,%llu\n", (unsigned long long)stats.inputUnderflows);
+    fprintf(out, "ring_overruns,%llu\n", (unsigned long long)stats.ringOverruns);
+    fprintf(out, "dropped_blocks,%llu\n", (unsigned long long)stats.droppedBlocks);
+    fprintf(out, "late_callbacks,%llu\n", (unsigned long long)stats.lateCallbacks);
+    fprintf(out, "block_period_ms,%.3f\n", stats.blockPeriodMs);
+    fprintf(out, "interval_mean_ms,%.3f\n", stats.intervalMeanMs);
+    fprintf(out, "interval_max_ms,%.3f\n", stats.intervalMaxMs);
+    fprintf(out, "jitter_rms_ms,%.3f\n", stats.jitterRmsMs);
+    fprintf(out, "callback_mean_us,%.2f\n", stats.callbackMeanUs);
+    fprintf(out, "callback_max_us,%.2f\n", stats.callbackMaxUs);
+    fprintf(out, "cpu_load,%.4f\n", stats.cpuLoad);
+    fprintf(out, "cpu_load_max,%.4f\n", stats.cpuLoadMax);
+
+    fclose(out);
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef AUDIOHEALTH_H
+#define AUDIOHEALTH_H
+
+#include <cstdint>
+
+// =========================================================
+// AUDIO CALLBACK HEALTH
+// =========================================================
+// Xruns, callback timing and dropped blocks, for sizing the device block and the
+// ring per machine. The audio callback (or a threaded source) records every block,
+// the analysis thread records the sequence numbers it sees and the thread that owns
+// the source polls its CPU load. Each counter has a single writer; readers never lock.
+
+#define HEALTH_LATE_FACTOR 1.5      // An interval this many block periods long is a late callback
+
+struct AudioHealthStats {
+    uint64_t callbacks = 0;
+    uint64_t frames = 0;
+    uint64_t inputOverflows = 0;    // paInputOverflow: the device lost input before the callback ran
+    uint64_t inputUnderflows = 0;   // paInputUnderflow: the device padded the input with silence
+    uint64_t ringOverruns = 0;      // Blocks the callback dropped on a full gAudioRing
+    uint64_t droppedBlocks = 0;     // Sequence numbers the analysis thread never saw
+    uint64_t lateCallbacks = 0;     // Intervals longer than HEALTH_LATE_FACTOR block periods
+    float blockPeriodMs = 0.0f;     // Expected interval at the current block size and rate
+    float intervalMeanMs = 0.0f;
+    float intervalMaxMs = 0.0f;
+    float jitterRmsMs = 0.0f;       // RMS of (interval - blockPeriodMs)
+    float callbackMeanUs = 0.0f;    // Time spent in our callback (de-interleave + push)
+    float callbackMaxUs = 0.0f;
+    float cpuLoad = 0.0f;           // Pa_GetStreamCpuLoad, 0..1 (0 for sources without one)
+    float cpuLoadMax = 0.0f;
+};
+
+// Audio callback / source thread. `period` is the nominal block duration in seconds;
+// `startTime` and `endTime` bracket the callback on the AnalysisClockNow() clock.
+void RecordAudioCallback(unsigned long frames, double period, bool inputOverflow, bool inputUnderflow,
+                         double startTime, double endTime);
+
+// Analysis thread, once per dequeued block.
+void RecordAnalysedSequence(uint64_t sequence);
+
+// Owner of the audio source, whenever convenient (the render loop polls once per frame).
+void RecordAudioCpuLoad(float load);
+
+// Safe from any thread.
+AudioHealthStats GetAudioHealthStats();
+
+// Also called when the source restarts so the stats describe the running format only.
+// Safe from any thread: each writer clears its own counters when it next records, and
+// readers see the cleared values from this call on.
+void ResetAudioHealthStats();
+
+// `metric,value` CSV of every field above. Returns false if the file cannot be written.
+bool DumpAudioHealthStats(const char* path);
+
+#endif // AUDIOHEALTH_H
@@ -0,0 +1,118 @@
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "globals.h"
+
+// =========================================================
+// LOCK-FREE SINGLE-PRODUCER / SINGLE-CONSUMER RING
+// =========================================================
+// The producer only ever writes `head`, the consumer only ever writes `tail`.
+// Slots are published with release stores and observed with acquire loads,
+// so a consumer never sees a half-written slot. A full ring drops the new
+// item and counts it instead of blocking the producer (the audio callback).
+
+#define SPSC_CACHE_LINE 64
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), overruns(0) {}
+
+    // --- PRODUCER SIDE ---
+
+    // Claim the next free slot for in-place writing. Returns nullptr (and counts
+    // an overrun) when the consumer has fallen a full ring behind.
+    T* BeginWrite() {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity) {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &slots[h & (Capacity - 1)];
+    }
+
+    // Publish the slot returned by BeginWrite.
+    void EndWrite() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool Push(const T& item) {
+        T* slot = BeginWrite();
+        if (!slot) return false;
+        *slot = item;
+        EndWrite();
+        return true;
+    }
+
+    // --- CONSUMER SIDE ---
+
+    // Peek at the oldest published slot without consuming it.
+    const T* BeginRead() const {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return nullptr;
+        return &slots[t & (Capacity - 1)];
+    }
+
+    // Release the slot returned by BeginRead back to the producer.
+    void EndRead() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool Pop(T& out) {
+        const T* slot = BeginRead();
+        if (!slot) return false;
+        out = *slot;
+        EndRead();
+        return true;
+    }
+
+    // --- STATS (safe from either side) ---
+    size_t Size() const {
+        return (size_t)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+    }
+    bool Empty() const { return Size() == 0; }
+    uint64_t Produced() const { return head.load(std::memory_order_acquire); }
+    uint64_t Overruns() const { return overruns.load(std::memory_order_relaxed); }
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    // Keep producer and consumer indices on separate cache lines to avoid false sharing.
+    alignas(SPSC_CACHE_LINE) std::atomic<uint64_t> head;
+    alignas(SPSC_CACHE_LINE) std::atomic<uint64_t> tail;
+    alignas(SPSC_CACHE_LINE) std::atomic<uint64_t> overruns;
+    alignas(SPSC_CACHE_LINE) T slots[Capacity];
+};
+
+// =========================================================
+// AUDIO BLOCKS
+// =========================================================
+
+// Slack before the callback starts dropping: 64 * blockFrames / sampleRate seconds
+// (e.g. 0.75 s for 512-frame blocks at 44.1 kHz, 0.09 s for 64-frame blocks at 48 kHz).
+#define AUDIO_RING_BLOCKS 64
+
+// Interleaved capture is split into per-channel planes (see channels.h)
+#define MAX_AUDIO_CHANNELS 4
+#define AUDIO_PLANE_ALIGNMENT 32
+
+struct AudioBlock {
+    uint64_t sequence;                   // Monotonic block counter set by the producer
+    unsigned long frames;                // Valid frames in `samples`
+    double captureTime;                  // ADC time of samples[0] on the AnalysisClockNow() clock
+    int sampleRate;                      // Capture rate in Hz (0 = DEFAULT_SAMPLE_RATE)
+    int blockFrames;                     // Nominal device block; `frames` is only smaller at the end of a stream (0 = frames)
+    int channels;                        // Captured channels; planes are only filled when > 1
+    alignas(AUDIO_PLANE_ALIGNMENT) float samples[FRAMES_PER_BUFFER];     // Mono mix (mean of all channels)
+    alignas(AUDIO_PLANE_ALIGNMENT) float planes[MAX_AUDIO_CHANNELS][FRAMES_PER_BUFFER];
+};
+
+typedef SpscRing<AudioBlock, AUDIO_RING_BLOCKS> AudioRing;
+
+extern AudioRing gAudioRing;
+
+#endif // AUDIORING_H
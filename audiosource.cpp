@@ -0,0 +1,542 @@
+#include "audiosource.h"
+#include "audioring.h"
+#include "analysis.h"
+#include "channels.h"
+#include "audiohealth.h"
+#include "capture.h"
+#include <portaudio.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+static const double TWO_PI = 6.283185307179586;
+
+// Unthrottled sources back off this long when the ring is full instead of dropping.
+#define SOURCE_BACKOFF_US 200
+
+static const char* audioSourceNames[AUDIO_SOURCE_TYPE_COUNT] = { "PortAudio", "PCM Pipe", "Generator", "Replay" };
+static const char* signalNames[SIGNAL_TYPE_COUNT] = { "sweep", "kicks", "pink", "impulses" };
+
+const char* GetAudioSourceName(int type) {
+    if (type < 0 || type >= AUDIO_SOURCE_TYPE_COUNT) return "Unknown";
+    return audioSourceNames[type];
+}
+
+const char* GetSignalName(int type) {
+    if (type < 0 || type >= SIGNAL_TYPE_COUNT) return "unknown";
+    return signalNames[type];
+}
+
+bool ParseAudioSourceArgs(int argc, char** argv, AudioSourceConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--unthrottled") == 0) {
+            config.unthrottled = true;
+        }
+        else if (strcmp(argv[i], "--channels") == 0 && i + 1 < argc) {
+            config.channels = atoi(argv[++i]);
+            if (config.channels < 1 || config.channels > MAX_AUDIO_CHANNELS) {
+                fprintf(stderr, "--channels must be 1..%d\n", MAX_AUDIO_CHANNELS);
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--sample-rate") == 0 && i + 1 < argc) {
+            config.sampleRate = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+            config.blockFrames = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pcm-file") == 0 && i + 1 < argc) {
+            config.pcmPath = argv[++i];
+            config.type = AUDIO_SOURCE_PCM_PIPE;
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            config.replayPath = argv[++i];
+            config.type = AUDIO_SOURCE_REPLAY;
+            if (!ReadCaptureFormat(config.replayPath, config.sampleRate, config.blockFrames, config.channels)) return false;
+        }
+        else if (strcmp(argv[i], "--source") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (strcmp(value, "portaudio") == 0) {
+                config.type = AUDIO_SOURCE_PORTAUDIO;
+            }
+            else if (strcmp(value, "pipe") == 0 || strcmp(value, "pipe:f32") == 0) {
+                config.type = AUDIO_SOURCE_PCM_PIPE;
+                config.pcmFormat = PCM_FLOAT32;
+            }
+            else if (strcmp(value, "pipe:s16") == 0) {
+                config.type = AUDIO_SOURCE_PCM_PIPE;
+                config.pcmFormat = PCM_S16;
+            }
+            else if (strncmp(value, "gen:", 4) == 0) {
+                config.type = AUDIO_SOURCE_GENERATOR;
+                config.signal = -1;
+                for (int s = 0; s < SIGNAL_TYPE_COUNT; s++) {
+                    if (strcmp(value + 4, signalNames[s]) == 0) config.signal = s;
+                }
+                if (config.signal < 0) {
+                    fprintf(stderr, "Unknown signal '%s' (sweep, kicks, pink, impulses)\n", value + 4);
+                    return false;
+                }
+            }
+            else {
+                fprintf(stderr, "Unknown audio source '%s' (portaudio, pipe, pipe:s16, gen:<signal>)\n", value);
+                return false;
+            }
+        }
+    }
+    if (!IsValidAudioFormat(config.sampleRate, config.blockFrames)) {
+        fprintf(stderr, "--sample-rate must be %d..%d and --block %d..%d\n",
+                MIN_SAMPLE_RATE, MAX_SAMPLE_RATE, MIN_BLOCK_FRAMES, FRAMES_PER_BUFFER);
+        return false;
+    }
+    return true;
+}
+
+bool PushAudioBlock(const float* interleaved, unsigned long frames, const AudioSourceConfig& format, double captureTime) {
+    // Never block here: if the analysis thread is a full ring behind, the block is dropped and counted.
+    AudioBlock* block = gAudioRing.BeginWrite();
+    if (!block) return false;
+
+    DeinterleaveBlock(interleaved, frames, format.channels, *block);
+    block->captureTime = captureTime;
+    block->sampleRate = format.sampleRate;
+    block->blockFrames = format.blockFrames;
+    // Dropped blocks still use up a sequence number so the consumer can see the gap
+    block->sequence = gAudioRing.Produced() + gAudioRing.Overruns();
+    gAudioRing.EndWrite();
+    NotifyAnalysisThread();
+    return true;
+}
+
+// =========================================================
+// RUNTIME FORMAT
+// =========================================================
+
+static std::atomic<int> activeSampleRate(DEFAULT_SAMPLE_RATE);
+static std::atomic<int> activeBlockFrames(FRAMES_PER_BUFFER);
+
+static std::mutex formatRequestMutex;
+static bool formatRequestPending = false;
+static int requestedSampleRate = DEFAULT_SAMPLE_RATE;
+static int requestedBlockFrames = FRAMES_PER_BUFFER;
+
+bool IsValidAudioFormat(int sampleRate, int blockFrames) {
+    return sampleRate >= MIN_SAMPLE_RATE && sampleRate <= MAX_SAMPLE_RATE &&
+           blockFrames >= MIN_BLOCK_FRAMES && blockFrames <= FRAMES_PER_BUFFER;
+}
+
+static void SetActiveAudioFormat(const AudioSourceConfig& config) {
+    activeSampleRate.store(config.sampleRate, std::memory_order_relaxed);
+    activeBlockFrames.store(config.blockFrames, std::memory_order_relaxed);
+}
+
+void GetActiveAudioFormat(int& sampleRate, int& blockFrames) {
+    sampleRate = activeSampleRate.load(std::memory_order_relaxed);
+    blockFrames = activeBlockFrames.load(std::memory_order_relaxed);
+}
+
+void RequestAudioFormat(int sampleRate, int blockFrames) {
+    if (!IsValidAudioFormat(sampleRate, blockFrames)) return;
+    std::lock_guard<std::mutex> lock(formatRequestMutex);
+    requestedSampleRate = sampleRate;
+    requestedBlockFrames = blockFrames;
+    formatRequestPending = true;
+}
+
+bool TakeAudioFormatRequest(AudioSourceConfig& config) {
+    std::lock_guard<std::mutex> lock(formatRequestMutex);
+    if (!formatRequestPending) return false;
+    formatRequestPending = false;
+    if (config.sampleRate == requestedSampleRate && config.blockFrames == requestedBlockFrames) return false;
+    config.sampleRate = requestedSampleRate;
+    config.blockFrames = requestedBlockFrames;
+    return true;
+}
+
+// =========================================================
+// SIGNAL GENERATOR
+// =========================================================
+
+SignalGenerator::SignalGenerator(int signal, int sampleRate) : signal(signal), sampleRate(sampleRate) {
+    Reset();
+}
+
+void SignalGenerator::Reset() {
+    position = 0;
+    phase = 0.0;
+    seed = SIGNAL_SEED;
+    for (float& p : pink) p = 0.0f;
+}
+
+// Uniform white noise in -1..1 from a fixed-seed LCG.
+float SignalGenerator::NextNoise() {
+    seed = seed * 1664525u + 1013904223u;
+    return (seed >> 8) / 8388608.0f - 1.0f;
+}
+
+void SignalGenerator::Generate(float* out, int frames) {
+    const double sweepSamples = SIGNAL_SWEEP_SECONDS * sampleRate;
+    const double sweepRatio = log(SIGNAL_SWEEP_HIGH_FREQ / SIGNAL_SWEEP_LOW_FREQ);
+    const uint64_t kickPeriod = (uint64_t)(sampleRate * 60.0 / SIGNAL_KICK_BPM);
+
+    for (int i = 0; i < frames; i++, position++) {
+        float value = 0.0f;
+        switch (signal) {
+            case SIGNAL_SINE_SWEEP: {
+                double t = fmod((double)position, sweepSamples) / sweepSamples;
+                double freq = SIGNAL_SWEEP_LOW_FREQ * exp(sweepRatio * t);
+                phase += TWO_PI * freq / sampleRate;
+                if (phase >= TWO_PI) phase -= TWO_PI;
+                value = SIGNAL_AMPLITUDE * (float)sin(phase);
+                break;
+            }
+            case SIGNAL_KICKS: {
+                uint64_t t = position % kickPeriod;
+                float envelope = expf(-(float)t / (0.08f * sampleRate));
+                float kick = envelope * (float)sin(TWO_PI * SIGNAL_KICK_FREQ * (double)t / sampleRate);
+                value = SIGNAL_AMPLITUDE * kick + 0.025f * NextNoise();
+                break;
+            }
+            case SIGNAL_PINK_NOISE: {
+                // Paul Kellet's refined pink filter (-3 dB/octave within ~0.05 dB)
+                float white = NextNoise();
+                pink[0] = 0.99886f * pink[0] + white * 0.0555179f;
+                pink[1] = 0.99332f * pink[1] + white * 0.0750759f;
+                pink[2] = 0.96900f * pink[2] + white * 0.1538520f;
+                pink[3] = 0.86650f * pink[3] + white * 0.3104856f;
+                pink[4] = 0.55000f * pink[4] + white * 0.5329522f;
+                pink[5] = -0.7616f * pink[5] - white * 0.0168980f;
+                float sum = pink[0] + pink[1] + pink[2] + pink[3] + pink[4] + pink[5] + pink[6] + white * 0.5362f;
+                pink[6] = white * 0.115926f;
+                value = SIGNAL_AMPLITUDE * 0.11f * sum;
+                break;
+            }
+            case SIGNAL_IMPULSES:
+                value = (position % (uint64_t)sampleRate == 0) ? 1.0f : 0.0f;
+                break;
+        }
+        out[i] = value;
+    }
+}
+
+void SignalGenerator::GenerateInterleaved(float* out, int frames, int channels) {
+    if (channels <= 1) {
+        Generate(out, frames);
+        return;
+    }
+    float mono[FRAMES_PER_BUFFER];
+    for (int done = 0; done < frames; ) {
+        int count = frames - done < FRAMES_PER_BUFFER ? frames - done : FRAMES_PER_BUFFER;
+        Generate(mono, count);
+        for (int i = 0; i < count; i++) {
+            float gain = 1.0f;
+            for (int c = 0; c < channels; c++, gain *= SIGNAL_CHANNEL_GAIN) {
+                out[(size_t)(done + i) * channels + c] = mono[i] * gain;
+            }
+        }
+        done += count;
+    }
+}
+
+// =========================================================
+// PORTAUDIO SOURCE
+// =========================================================
+
+static int PortAudioCallback(const void* inputBuffer, void* outputBuffer,
+    unsigned long framesPerBuffer,
+    const PaStreamCallbackTimeInfo* timeInfo,
+    PaStreamCallbackFlags statusFlags,
+    void* userData) {
+    // Move the ADC time onto our clock by its age relative to the stream clock.
+    // Some host APIs report 0 for it; the callback time is the best we have there.
+    double now = AnalysisClockNow();
+    const AudioSourceConfig* config = (const AudioSourceConfig*)userData;
+    if (inputBuffer != NULL) {
+        double captureTime = now;
+        if (timeInfo && timeInfo->inputBufferAdcTime > 0.0 && timeInfo->currentTime >= timeInfo->inputBufferAdcTime) {
+            captureTime = now - (timeInfo->currentTime - timeInfo->inputBufferAdcTime);
+        }
+        PushAudioBlock((const float*)inputBuffer, framesPerBuffer, *config, captureTime);
+    }
+    RecordAudioCallback(framesPerBuffer, (double)config->blockFrames / config->sampleRate, (statusFlags & paInputOverflow) != 0,
+                        (statusFlags & paInputUnderflow) != 0, now, AnalysisClockNow());
+    return paContinue;
+}
+
+class PortAudioSource : public AudioSource {
+public:
+    PortAudioSource(const AudioSourceConfig& config) : stream(nullptr), config(config) {}
+    ~PortAudioSource() { Stop(); }
+
+    bool Start() override {
+        if (Pa_Initialize() != paNoError) return false;
+        if (Pa_OpenDefaultStream(&stream, config.channels, 0, paFloat32, config.sampleRate, config.blockFrames, PortAudioCallback, &config) != paNoError ||
+            Pa_StartStream(stream) != paNoError) {
+            if (stream) Pa_CloseStream(stream);
+            stream = nullptr;
+            Pa_Terminate();
+            return false;
+        }
+        SetActiveAudioFormat(config);
+        return true;
+    }
+
+    void Stop() override {
+        if (!stream) return;
+        Pa_StopStream(stream);
+        Pa_CloseStream(stream);
+        Pa_Terminate();
+        stream = nullptr;
+    }
+
+    const char* GetName() const override { return GetAudioSourceName(AUDIO_SOURCE_PORTAUDIO); }
+
+    float GetCpuLoad() const override { return stream ? (float)Pa_GetStreamCpuLoad(stream) : 0.0f; }
+
+private:
+    PaStream* stream;
+    AudioSourceConfig config;   // Read by the callback through userData
+};
+
+// =========================================================
+// THREADED SOURCES (pipe, generator)
+// =========================================================
+// Produce blocks on their own thread. Realtime mode sleeps until each block's
+// wall-clock deadline; unthrottled mode pushes as fast as the ring has room,
+// waiting instead of dropping so every sample is analysed.
+
+class ThreadedAudioSource : public AudioSource {
+public:
+    ThreadedAudioSource(const AudioSourceConfig& config)
+        : format(config), running(false), finished(false) {}
+    ~ThreadedAudioSource() { Stop(); }
+
+    bool Start() override {
+        if (running.exchange(true)) return true;
+        finished.store(false);
+        SetActiveAudioFormat(format);
+        worker = std::thread(&ThreadedAudioSource::Run, this);
+        return true;
+    }
+
+    void Stop() override {
+        running.store(false);
+        if (worker.joinable()) worker.join();
+    }
+
+    bool IsFinished() const override { return finished.load(); }
+
+protected:
+    // Fill up to `frames` interleaved frames of `channels` samples. Returns the frame count, 0 at end of input.
+    virtual int Produce(float* samples, int frames, int channels) = 0;
+
+private:
+    void Run() {
+        float samples[FRAMES_PER_BUFFER * MAX_AUDIO_CHANNELS];
+        auto start = std::chrono::steady_clock::now();
+        uint64_t produced = 0;
+
+        while (running.load()) {
+            int want = format.blockFrames;
+            if (format.maxFrames > 0 && format.maxFrames - produced < (uint64_t)want) want = (int)(format.maxFrames - produced);
+            int frames = (want > 0) ? Produce(samples, want, format.channels) : 0;
+            if (frames <= 0) break;
+
+            if (format.unthrottled) {
+                while (running.load() && gAudioRing.Size() >= gAudioRing.GetCapacity()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(SOURCE_BACKOFF_US));
+                }
+            } else {
+                std::this_thread::sleep_until(start + std::chrono::duration<double>((double)(produced + (uint64_t)frames) / format.sampleRate));
+            }
+            // Like an ADC, the first sample of the block was "captured" one block ago
+            double now = AnalysisClockNow();
+            PushAudioBlock(samples, (unsigned long)frames, format, now - (double)frames / format.sampleRate);
+            RecordAudioCallback((unsigned long)frames, (double)format.blockFrames / format.sampleRate, false, false, now, AnalysisClockNow());
+            produced += (uint64_t)frames;
+        }
+        finished.store(true);
+    }
+
+    AudioSourceConfig format;
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+    std::thread worker;
+};
+
+class PcmPipeSource : public ThreadedAudioSource {
+public:
+    PcmPipeSource(const AudioSourceConfig& config)
+        : ThreadedAudioSource(config), format(config.pcmFormat), path(config.pcmPath), file(nullptr) {}
+    ~PcmPipeSource() {
+        Stop();
+        if (file && file != stdin) fclose(file);
+    }
+
+    bool Start() override {
+        if (!file) {
+            if (path) {
+                file = fopen(path, "rb");
+                if (!file) return false;
+            } else {
+#ifdef _WIN32
+                _setmode(_fileno(stdin), _O_BINARY);
+#endif
+                file = stdin;
+            }
+        }
+        return ThreadedAudioSource::Start();
+    }
+
+    const char* GetName() const override { return GetAudioSourceName(AUDIO_SOURCE_PCM_PIPE); }
+
+protected:
+    int Produce(float* samples, int frames, int channels) override {
+        size_t frameSamples = (size_t)channels;
+        if (format == PCM_S16) {
+            int16_t raw[FRAMES_PER_BUFFER * MAX_AUDIO_CHANNELS];
+            int got = (int)(fread(raw, sizeof(int16_t) * frameSamples, (size_t)frames, file));
+            for (size_t i = 0; i < (size_t)got * frameSamples; i++) samples[i] = raw[i] / 32768.0f;
+            return got;
+        }
+        return (int)fread(samples, sizeof(float) * frameSamples, (size_t)frames, file);
+    }
+
+private:
+    int format;
+    const char* path;
+    FILE* file;
+};
+
+class GeneratorSource : public ThreadedAudioSource {
+public:
+    GeneratorSource(const AudioSourceConfig& config)
+        : ThreadedAudioSource(config), generator(config.signal, config.sampleRate) {}
+    ~GeneratorSource() { Stop(); }
+
+    const char* GetName() const override { return GetAudioSourceName(AUDIO_SOURCE_GENERATOR); }
+
+protected:
+    int Produce(float* samples, int frames, int channels) override {
+        generator.GenerateInterleaved(samples, frames, channels);
+        return frames;
+    }
+
+private:
+    SignalGenerator generator;
+};
+
+// =========================================================
+// REPLAY SOURCE
+// =========================================================
+// Feeds a capture back block by block with each block's own frame count and format.
+// A settings record is applied only once the ring has drained, so the analyzer
+// switches on the same block boundary as the recording did.
+
+class ReplaySource : public AudioSource {
+public:
+    ReplaySource(const AudioSourceConfig& config) : config(config), running(false), finished(false) {}
+    ~ReplaySource() { Stop(); }
+
+    bool Start() override {
+        if (running.load()) return true;
+        if (!config.replayPath || !capture.Open(config.replayPath)) return false;
+        running.store(true);
+        finished.store(false);
+        SetActiveAudioFormat(config);
+        worker = std::thread(&ReplaySource::Run, this);
+        return true;
+    }
+
+    void Stop() override {
+        running.store(false);
+        if (worker.joinable()) worker.join();
+        capture.Close();
+    }
+
+    bool IsFinished() const override { return finished.load(); }
+    const char* GetName() const override { return GetAudioSourceName(AUDIO_SOURCE_REPLAY); }
+
+private:
+    void WaitForRing(size_t below) {
+        while (running.load() && gAudioRing.Size() > below) {
+            std::this_thread::sleep_for(std::chrono::microseconds(SOURCE_BACKOFF_US));
+        }
+    }
+
+    void Run() {
+        float samples[FRAMES_PER_BUFFER * MAX_AUDIO_CHANNELS];
+        auto start = std::chrono::steady_clock::now();
+        uint64_t produced = 0;
+        double playedSeconds = 0.0;
+
+        for (size_t r = 0; r < capture.GetRecordCount() && running.load(); r++) {
+            const CaptureRecord& record = capture.GetRecord(r);
+            if (record.type == CAPTURE_RECORD_SETTINGS) {
+                // The analyzer picks settings up at the start of a block: let it finish the queued ones first
+                WaitForRing(0);
+                AnalysisSettings settings;
+                memcpy(&settings, capture.GetPayload(r), sizeof(settings));
+                SetAnalysisSettings(settings);
+                continue;
+            }
+            if (record.type != CAPTURE_RECORD_AUDIO) continue;
+
+            CaptureAudio audio;
+            memcpy(&audio, capture.GetPayload(r), sizeof(audio));
+            if (audio.frames == 0 || audio.frames > FRAMES_PER_BUFFER || audio.channels < 1 || audio.channels > MAX_AUDIO_CHANNELS ||
+                record.size < sizeof(audio) + sizeof(float) * audio.frames * audio.channels ||
+                !IsValidAudioFormat(audio.sampleRate, audio.blockFrames)) {
+                fprintf(stderr, "Replay stopped at a malformed block (record %zu)\n", r);
+                break;
+            }
+            if (config.maxFrames > 0 && produced + audio.frames > config.maxFrames) break;
+
+            const float* planes = (const float*)((const uint8_t*)capture.GetPayload(r) + sizeof(audio));
+            for (uint32_t i = 0; i < audio.frames; i++) {
+                for (int c = 0; c < audio.channels; c++) samples[(size_t)i * audio.channels + c] = planes[(size_t)c * audio.frames + i];
+            }
+
+            AudioSourceConfig format = config;
+            format.channels = audio.channels;
+            format.sampleRate = audio.sampleRate;
+            format.blockFrames = audio.blockFrames;
+            playedSeconds += (double)audio.frames / audio.sampleRate;
+            if (config.unthrottled) {
+                WaitForRing(gAudioRing.GetCapacity() - 1);
+            } else {
+                std::this_thread::sleep_until(start + std::chrono::duration<double>(playedSeconds));
+            }
+            double now = AnalysisClockNow();
+            PushAudioBlock(samples, audio.frames, format, now - (double)audio.frames / audio.sampleRate);
+            RecordAudioCallback(audio.frames, (double)audio.blockFrames / audio.sampleRate, false, false, now, AnalysisClockNow());
+            produced += audio.frames;
+        }
+        finished.store(true);
+    }
+
+    AudioSourceConfig config;
+    CaptureFile capture;
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+    std::thread worker;
+};
+
+AudioSource* CreateAudioSource(const AudioSourceConfig& config) {
+    switch (config.type) {
+        case AUDIO_SOURCE_PORTAUDIO: return new PortAudioSource(config);
+        case AUDIO_SOURCE_PCM_PIPE:  return new PcmPipeSource(config);
+        case AUDIO_SOURCE_GENERATOR: return new GeneratorSource(config);
+        case AUDIO_SOURCE_REPLAY:    return new ReplaySource(config);
+    }
+    return nullptr;
+}
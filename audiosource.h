@@ -0,0 +1,139 @@
+#ifndef AUDIOSOURCE_H
+#define AUDIOSOURCE_H
+
+#include <cstdint>
+#include "globals.h"
+
+// =========================================================
+// AUDIO SOURCES
+// =========================================================
+// Every source feeds the same pipeline: blocks of FRAMES_PER_BUFFER interleaved
+// frames of `channels` samples are split into planes (channels.h), pushed into
+// gAudioRing and the analysis thread is woken. PortAudio is the
+// live default; the pipe and generator sources need no sound card and run either
+// paced to realtime or unthrottled (as fast as the analysis thread drains).
+
+enum AudioSourceType {
+    AUDIO_SOURCE_PORTAUDIO,     // Default input device
+    AUDIO_SOURCE_PCM_PIPE,      // Raw interleaved PCM from stdin (or a file)
+    AUDIO_SOURCE_GENERATOR,     // Built-in synthetic signal
+    AUDIO_SOURCE_REPLAY,        // Blocks and settings of a capture file (see capture.h)
+    AUDIO_SOURCE_TYPE_COUNT
+};
+
+enum PcmFormat {
+    PCM_FLOAT32,
+    PCM_S16
+};
+
+enum SignalType {
+    SIGNAL_SINE_SWEEP,          // Log sweep 20 Hz..2 kHz, repeating
+    SIGNAL_KICKS,               // 50 Hz kicks at SIGNAL_KICK_BPM over low-level noise
+    SIGNAL_PINK_NOISE,
+    SIGNAL_IMPULSES,            // One full-scale sample per second
+    SIGNAL_TYPE_COUNT
+};
+
+#define SIGNAL_SWEEP_LOW_FREQ   20.0
+#define SIGNAL_SWEEP_HIGH_FREQ  2000.0
+#define SIGNAL_SWEEP_SECONDS    10.0
+#define SIGNAL_KICK_BPM         128.0
+#define SIGNAL_KICK_FREQ        50.0
+#define SIGNAL_AMPLITUDE        0.5f
+#define SIGNAL_SEED             12345u
+#define SIGNAL_CHANNEL_GAIN     0.5f
+
+const char* GetAudioSourceName(int type);
+const char* GetSignalName(int type);
+
+struct AudioSourceConfig {
+    int type = AUDIO_SOURCE_PORTAUDIO;
+    int signal = SIGNAL_KICKS;
+    int pcmFormat = PCM_FLOAT32;
+    int channels = 1;               // 1..MAX_AUDIO_CHANNELS interleaved input channels
+    int sampleRate = DEFAULT_SAMPLE_RATE;
+    int blockFrames = FRAMES_PER_BUFFER;    // Device buffer, MIN_BLOCK_FRAMES..FRAMES_PER_BUFFER
+    const char* pcmPath = nullptr;  // nullptr reads stdin
+    const char* replayPath = nullptr;   // Capture file of the replay source
+    bool unthrottled = false;       // Pipe / generator / replay only; PortAudio is always realtime
+    uint64_t maxFrames = 0;         // Pipe / generator / replay stop after this many frames (0 = no limit)
+};
+
+// Consumes `--source portaudio|pipe|pipe:s16|gen:sweep|gen:kicks|gen:pink|gen:impulses`,
+// `--pcm-file <path>`, `--replay <capture>`, `--channels <n>`, `--sample-rate <hz>`,
+// `--block <frames>` and `--unthrottled` from argv. `--replay` takes the format of the
+// capture's first block. Unrelated arguments are ignored.
+// Returns false (after printing why) on a malformed option.
+bool ParseAudioSourceArgs(int argc, char** argv, AudioSourceConfig& config);
+
+// De-interleave one block into gAudioRing and wake the analysis thread. Channel count,
+// sample rate and nominal block size come from `format`. `captureTime`
+// is the ADC time of the first frame on the AnalysisClockNow() clock. Never blocks;
+// returns false if the ring was full and the block was dropped.
+bool PushAudioBlock(const float* interleaved, unsigned long frames, const AudioSourceConfig& format, double captureTime);
+
+// --- RUNTIME FORMAT ---
+// Sample rate and device block size are fixed per running source. Changing them
+// restarts the source only; the analyzer follows the rate carried by each block.
+
+#define MIN_SAMPLE_RATE  8000
+#define MAX_SAMPLE_RATE  192000
+#define MIN_BLOCK_FRAMES 16
+
+bool IsValidAudioFormat(int sampleRate, int blockFrames);
+
+// Format of the most recently started source (for display).
+void GetActiveAudioFormat(int& sampleRate, int& blockFrames);
+
+// UI side: ask the owner of the running source to restart it with a new format.
+void RequestAudioFormat(int sampleRate, int blockFrames);
+
+// Owner side: folds a pending request into `config`. True if the source must be restarted.
+bool TakeAudioFormatRequest(AudioSourceConfig& config);
+
+// --- GENERATOR ---
+// Deterministic: the same signal type always produces the same samples.
+// Multi-channel output repeats the signal with channel c scaled by SIGNAL_CHANNEL_GAIN^c,
+// so stereo has a non-silent side signal.
+class SignalGenerator {
+public:
+    explicit SignalGenerator(int signal = SIGNAL_KICKS, int sampleRate = DEFAULT_SAMPLE_RATE);
+
+    void Reset();
+    void Generate(float* out, int frames);
+
+    // `frames` interleaved frames of `channels` samples.
+    void GenerateInterleaved(float* out, int frames, int channels);
+
+private:
+    int signal;
+    int sampleRate;
+    uint64_t position;
+    double phase;
+    unsigned int seed;
+    float pink[7];
+
+    float NextNoise();
+};
+
+// --- SOURCE INTERFACE ---
+class AudioSource {
+public:
+    virtual ~AudioSource() {}
+
+    virtual bool Start() = 0;
+    virtual void Stop() = 0;
+
+    // True once a finite source (pipe at EOF, maxFrames reached) has delivered its last block.
+    virtual bool IsFinished() const { return false; }
+    virtual const char* GetName() const = 0;
+
+    // Fraction of the block period spent in the audio callback (0 when unknown).
+    // Call from the thread that owns the source, never from the callback.
+    virtual float GetCpuLoad() const { return 0.0f; }
+};
+
+// nullptr if the type is unknown. The caller owns the source.
+AudioSource* CreateAudioSource(const AudioSourceConfig& config);
+
+#endif // AUDIOSOURCE_H
@@ -0,0 +1,63 @@
+#include "autogain.h"
+#include <cmath>
+
+// Renormalise the lazily decayed counts before the weight can lose float precision
+#define AUTOGAIN_RESCALE_WEIGHT 1e6f
+
+static const float bucketsPerDecade = AUTOGAIN_BUCKETS / AUTOGAIN_DECADES;
+
+AutoGain::AutoGain() {
+    Reset(AUTOGAIN_MIN_REFERENCE);
+}
+
+void AutoGain::Reset(float initialReference) {
+    for (float& count : counts) count = 0.0f;
+    total = 0.0f;
+    weight = 1.0f;
+    reference = initialReference > AUTOGAIN_MIN_REFERENCE ? initialReference : AUTOGAIN_MIN_REFERENCE;
+}
+
+float AutoGain::GetPercentile(float percentile) const {
+    if (total <= 0.0f) return reference;
+
+    float target = percentile * total;
+    float seen = 0.0f;
+    for (int b = 0; b < AUTOGAIN_BUCKETS; b++) {
+        if (seen + counts[b] >= target && counts[b] > 0.0f) {
+            // Geometric interpolation between the bucket edges
+            float fraction = (target - seen) / counts[b];
+            return AUTOGAIN_MIN_LEVEL * powf(10.0f, ((float)b + fraction) / bucketsPerDecade);
+        }
+        seen += counts[b];
+    }
+    return AUTOGAIN_MIN_LEVEL * powf(10.0f, AUTOGAIN_DECADES);
+}
+
+float AutoGain::Process(float level, float dt, float percentile, float attackSec, float releaseSec) {
+    // --- HISTOGRAM UPDATE (lazy exponential fade) ---
+    int bucket = 0;
+    if (level > AUTOGAIN_MIN_LEVEL) {
+        bucket = (int)(log10f(level / AUTOGAIN_MIN_LEVEL) * bucketsPerDecade);
+        if (bucket >= AUTOGAIN_BUCKETS) bucket = AUTOGAIN_BUCKETS - 1;
+    }
+    counts[bucket] += weight;
+    total += weight;
+    weight /= expf(-dt / AUTOGAIN_WINDOW_SEC);
+
+    if (weight > AUTOGAIN_RESCALE_WEIGHT) {
+        float scale = 1.0f / weight;
+        for (float& count : counts) count *= scale;
+        total *= scale;
+        weight = 1.0f;
+    }
+
+    // --- REFERENCE FOLLOWER ---
+    float target = GetPercentile(percentile);
+    if (target < AUTOGAIN_MIN_REFERENCE) target = AUTOGAIN_MIN_REFERENCE;
+    float timeConstant = (target > reference) ? attackSec : releaseSec;
+    float coefficient = (timeConstant > 0.0f) ? 1.0f - expf(-dt / timeConstant) : 1.0f;
+    reference += (target - reference) * coefficient;
+
+    float normalised = level / reference;
+    return (normalised > 1.0f) ? 1.0f : normalised;
+}
@@ -0,0 +1,49 @@
+#ifndef AUTOGAIN_H
+#define AUTOGAIN_H
+
+// =========================================================
+// ADAPTIVE GAIN
+// =========================================================
+// Replaces a fixed normalisation factor with a running high percentile of the
+// input level. Levels go into a log-spaced histogram whose old counts fade with
+// a AUTOGAIN_WINDOW_SEC time constant; the fade is applied lazily by growing the
+// weight of new samples, so an update costs a fixed 72-bucket scan and memory is
+// fixed. The chosen percentile is followed by a reference level with separate
+// attack (rising) and release (falling) times, and each level is reported as
+// level / reference. `--bench autogain` compares -30 and -1 dBFS kicks.
+
+#define AUTOGAIN_BUCKETS        72
+#define AUTOGAIN_MIN_LEVEL      0.01f       // Lower edge of the histogram (magnitude units)
+#define AUTOGAIN_DECADES        6.0f        // Histogram spans MIN_LEVEL .. MIN_LEVEL * 10^DECADES
+#define AUTOGAIN_WINDOW_SEC     10.0f       // Histogram memory
+#define AUTOGAIN_MIN_REFERENCE  2.0f        // Caps the gain so silence and hiss stay dark
+
+#define AUTOGAIN_DEFAULT_PERCENTILE  0.95f
+#define AUTOGAIN_DEFAULT_ATTACK_SEC  0.25f
+#define AUTOGAIN_DEFAULT_RELEASE_SEC 4.0f
+
+class AutoGain {
+public:
+    AutoGain();
+
+    // Forget the history; the reference restarts at `initialReference`.
+    void Reset(float initialReference);
+
+    // Feed one level measured `dt` seconds after the previous one.
+    // Returns level / reference clamped to 0..1.
+    float Process(float level, float dt, float percentile, float attackSec, float releaseSec);
+
+    // Current normalisation reference (same units as the input level).
+    float GetReference() const { return reference; }
+
+    // Percentile of the faded histogram, resolved inside its bucket.
+    float GetPercentile(float percentile) const;
+
+private:
+    float counts[AUTOGAIN_BUCKETS];
+    float total;
+    float weight;           // Weight of the next sample; grows by 1/decay per update
+    float reference;
+};
+
+#endif // AUTOGAIN_H
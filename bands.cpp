@@ -0,0 +1,70 @@
+#include "bands.h"
+#include <cmath>
+
+static const float BAND_EDGES[NUM_BANDS + 1] = {
+    20.0f, 60.0f, 250.0f, 500.0f, 2000.0f, 6000.0f, 20000.0f
+};
+
+// Magnitude that reads 1.0, relative to BASS_NORM_FACTOR. A flat factor left everything
+// above the bass near 0; these follow the -3 dB/octave tilt of pink noise (measured per
+// band at 8192 points), so a pink spectrum reads the same level in every band.
+static const float BAND_NORM_SCALE[NUM_BANDS] = {
+    2.0f, 1.0f, 0.6f, 0.35f, 0.19f, 0.105f
+};
+
+const char* GetBandName(int band) {
+    switch (band) {
+        case BAND_SUB_BASS: return "Sub";
+        case BAND_BASS:     return "Bass";
+        case BAND_LOW_MID:  return "LowMid";
+        case BAND_MID:      return "Mid";
+        case BAND_PRESENCE: return "Pres";
+        case BAND_AIR:      return "Air";
+        default:            return "?";
+    }
+}
+
+void BuildBandTable(BandTable& table, int fftSize, float sampleRate) {
+    table.fftSize = fftSize;
+    table.sampleRate = sampleRate;
+
+    int bins = fftSize / 2 + 1;
+    float freqRes = sampleRate / (float)fftSize;
+
+    int taken = 0;  // Bins below this already belong to a lower band
+    for (int b = 0; b < NUM_BANDS; b++) {
+        int first = (int)ceilf(BAND_EDGES[b] / freqRes);
+        int last  = (int)ceilf(BAND_EDGES[b + 1] / freqRes);
+        if (first < taken) first = taken;
+        if (last > bins) last = bins;
+        if (last <= first) last = first + 1;
+        if (BAND_EDGES[b] >= sampleRate * 0.5f || last > bins) {
+            table.firstBin[b] = table.lastBin[b] = 0;
+            table.invCount[b] = 0.0f;
+            continue;
+        }
+        taken = last;
+
+        table.firstBin[b] = first;
+        table.lastBin[b] = last;
+        table.invCount[b] = 1.0f / (float)(last - first);
+    }
+}
+
+void ComputeBandMagnitudes(const FFTSpectrum& spectrum, const BandTable& table, float* magnitudesOut) {
+    for (int b = 0; b < NUM_BANDS; b++) {
+        magnitudesOut[b] = SumRange(spectrum.magnitude, table.firstBin[b], table.lastBin[b]) * table.invCount[b];
+    }
+}
+
+float GetBandNormFactor(int band) {
+    return BASS_NORM_FACTOR * BAND_NORM_SCALE[band];
+}
+
+void ComputeBands(const FFTSpectrum& spectrum, const BandTable& table, float* bandsOut) {
+    ComputeBandMagnitudes(spectrum, table, bandsOut);
+    for (int b = 0; b < NUM_BANDS; b++) {
+        float level = bandsOut[b] / GetBandNormFactor(b);
+        bandsOut[b] = (level > 1.0f) ? 1.0f : level;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef BANDS_H
+#define BANDS_H
+
+#include "fft.h"
+
+// =========================================================
+// MULTI-BAND ANALYZER
+// =========================================================
+// Six roughly octave-spaced bands from sub-bass to air. Each band maps to a
+// contiguous bin range that is precomputed once per FFT size, so a block only
+// costs one SIMD sum per band on top of the magnitude kernel.
+
+enum BandId {
+    BAND_SUB_BASS,      //    20 -    60 Hz
+    BAND_BASS,          //    60 -   250 Hz
+    BAND_LOW_MID,       //   250 -   500 Hz
+    BAND_MID,           //   500 -  2000 Hz
+    BAND_PRESENCE,      //  2000 -  6000 Hz
+    BAND_AIR,           //  6000 - 20000 Hz
+    NUM_BANDS
+};
+
+const char* GetBandName(int band);
+
+struct BandTable {
+    int fftSize = 0;
+    float sampleRate = 0.0f;
+    int firstBin[NUM_BANDS] = {};   // Inclusive
+    int lastBin[NUM_BANDS] = {};    // Exclusive
+    float invCount[NUM_BANDS] = {};
+};
+
+// Bins whose centre frequency falls inside a band belong to it, and no bin belongs to
+// two bands. A band narrower than one bin still gets the next free bin so it never
+// reads as silent, which at coarse sizes moves the band above it up by a bin (at 512
+// points: sub-bass bin 1, bass bin 2). A band entirely above Nyquist (decimated
+// spectra), or left without a free bin, gets no bins and reads 0.
+void BuildBandTable(BandTable& table, int fftSize, float sampleRate);
+
+// Raw mean magnitude per band.
+void ComputeBandMagnitudes(const FFTSpectrum& spectrum, const BandTable& table, float* magnitudesOut);
+
+// Magnitude that maps a band to 1.0: BASS_NORM_FACTOR tilted per band so pink noise
+// reads evenly across all six. Also the starting reference of the per-band auto gain.
+float GetBandNormFactor(int band);
+
+// Mean magnitude per band, scaled by 1 / GetBandNormFactor and clamped to 0..1.
+void ComputeBands(const FFTSpectrum& spectrum, const BandTable& table, float* bandsOut);
+
+#endif // BANDS_H
@@ -0,0 +1,184 @@
+#include "beat.h"
+#include "fft.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+BeatTracker::BeatTracker()
+    : bins(0), fluxBins(0), hopSize(0), sampleRate((float)DEFAULT_SAMPLE_RATE), spectrumRate((float)DEFAULT_SAMPLE_RATE), previous(nullptr)
+{
+    Reset();
+}
+
+BeatTracker::~BeatTracker() {
+    FreeAligned(previous);
+}
+
+void BeatTracker::Configure(int newBins, int newHop, float newSampleRate, float newSpectrumRate) {
+    if (newBins != bins) {
+        FreeAligned(previous);
+        previous = AllocAlignedFloats(newBins);
+    }
+    bins = previous ? newBins : 0;
+    hopSize = newHop;
+    sampleRate = newSampleRate;
+    spectrumRate = newSpectrumRate;
+
+    int fftSize = (bins - 1) * 2;
+    float freqRes = (fftSize > 0) ? spectrumRate / (float)fftSize : 1.0f;
+    fluxBins = (int)(BEAT_MAX_FREQ / freqRes) + 1;
+    if (fluxBins > bins) fluxBins = bins;
+
+    float hopSeconds = (float)hopSize / sampleRate;
+    minLag = (int)(60.0f / (BEAT_MAX_BPM * hopSeconds));
+    maxLag = (int)ceilf(60.0f / (BEAT_MIN_BPM * hopSeconds));
+    if (minLag < 1) minLag = 1;
+    if (maxLag > BEAT_MAX_LAGS - 1) {
+        maxLag = BEAT_MAX_LAGS - 1;
+        fprintf(stderr, "Beat tracker: a %d-sample hop at %.0f Hz only reaches down to %.0f BPM\n",
+                hopSize, sampleRate, 60.0f / (maxLag * hopSeconds));
+    }
+    acfDecay = expf(-hopSeconds / BEAT_ACF_DECAY_SEC);
+
+    Reset();
+}
+
+void BeatTracker::Reset() {
+    if (previous) memset(previous, 0, sizeof(float) * bins);
+    memset(fluxHistory, 0, sizeof(fluxHistory));
+    memset(onsetHistory, 0, sizeof(onsetHistory));
+    memset(acf, 0, sizeof(acf));
+    fluxPos = 0;
+    fluxCount = 0;
+    fluxSum = 0.0;
+    fluxSumSq = 0.0;
+    onsetPos = 0;
+    bpm = 0.0f;
+    onset = 0.0f;
+    hops = 0;
+    lastBeat = 0;
+    nextBeat = 0.0;
+    lastOnset = 0;
+    lastConfirmed = 0;
+}
+
+void BeatTracker::UpdateTempo() {
+    int best = 0;
+    float bestScore = 0.0f;
+    float hopSeconds = (float)hopSize / sampleRate;
+
+    for (int lag = minLag; lag <= maxLag; lag++) {
+        // Log-Gaussian tempo prior around BEAT_PRIOR_BPM
+        float lagBpm = 60.0f / (lag * hopSeconds);
+        float octaves = log2f(lagBpm / BEAT_PRIOR_BPM);
+        float score = acf[lag] * expf(-0.5f * octaves * octaves);
+        if (score > bestScore) {
+            bestScore = score;
+            best = lag;
+        }
+    }
+    if (best == 0) return;
+
+    // Parabolic interpolation for sub-hop lag resolution
+    float lag = (float)best;
+    if (best > minLag && best < maxLag) {
+        float a = acf[best - 1], b = acf[best], c = acf[best + 1];
+        float denom = a - 2.0f * b + c;
+        if (denom < 0.0f) lag += 0.5f * (a - c) / denom;
+    }
+    bpm = 60.0f / (lag * hopSeconds);
+}
+
+bool BeatTracker::Process(const float* magnitude, uint64_t samplePosition, BeatEvent& event) {
+    if (!previous || bins <= 0) return false;
+
+    // 1. Spectral flux
+    float flux = 0.0f;
+    for (int i = 1; i < fluxBins; i++) {
+        float diff = magnitude[i] - previous[i];
+        if (diff > 0.0f) flux += diff;
+    }
+    memcpy(previous, magnitude, sizeof(float) * bins);
+    flux /= (float)fluxBins;
+
+    // 2. Adaptive threshold over the previous BEAT_FLUX_HISTORY hops
+    float mean = (fluxCount > 0) ? (float)(fluxSum / fluxCount) : 0.0f;
+    float variance = (fluxCount > 0) ? (float)(fluxSumSq / fluxCount) - mean * mean : 0.0f;
+    float threshold = mean + BEAT_THRESHOLD_K * sqrtf(variance > 0.0f ? variance : 0.0f);
+    if (threshold < mean * BEAT_THRESHOLD_RATIO) threshold = mean * BEAT_THRESHOLD_RATIO;
+    if (threshold < BEAT_FLUX_FLOOR) threshold = BEAT_FLUX_FLOOR;
+
+    float old = fluxHistory[fluxPos];
+    fluxSum += flux - old;
+    fluxSumSq += (double)flux * flux - (double)old * old;
+    fluxHistory[fluxPos] = flux;
+    fluxPos = (fluxPos + 1) % BEAT_FLUX_HISTORY;
+    if (fluxCount < BEAT_FLUX_HISTORY) fluxCount++;
+
+    onset = (flux > mean) ? flux - mean : 0.0f;
+    hops++;
+
+    // 3. Tempo: leaky autocorrelation of the onset envelope
+    onsetHistory[onsetPos] = onset;
+    for (int lag = minLag; lag <= maxLag; lag++) {
+        float past = onsetHistory[(onsetPos - lag + BEAT_MAX_LAGS) % BEAT_MAX_LAGS];
+        acf[lag] = acf[lag] * acfDecay + onset * past;
+    }
+    onsetPos = (onsetPos + 1) % BEAT_MAX_LAGS;
+    UpdateTempo();
+
+    // 4. Onset detection with a refractory period of the fastest tempo
+    uint64_t minGap = (uint64_t)(60.0f / BEAT_MAX_BPM * sampleRate);
+    bool isOnset = fluxCount >= BEAT_FLUX_HISTORY / 2 && flux > threshold && onset > 0.0f &&
+                   (lastOnset == 0 || samplePosition - lastOnset >= minGap);
+    if (isOnset) lastOnset = samplePosition;
+
+    // 5. Phase tracking
+    if (bpm <= 0.0f) {
+        if (!isOnset) return false;
+        lastBeat = samplePosition;
+        lastConfirmed = samplePosition;
+        event = { samplePosition, flux - threshold, bpm, false };
+        return true;
+    }
+
+    double period = 60.0 * sampleRate / bpm;
+    double tolerance = period * BEAT_PHASE_TOLERANCE;
+    double position = (double)samplePosition;
+    bool lost = nextBeat <= 0.0 || position - (double)lastConfirmed > BEAT_FLYWHEEL_BEATS * period;
+
+    if (!lost && position >= nextBeat) {
+        // Predicted beat time reached; an onset on this hop confirms it
+        lastBeat = samplePosition;
+        if (isOnset) lastConfirmed = samplePosition;
+        nextBeat = isOnset ? position + period : nextBeat + period;
+        event = { samplePosition, isOnset ? flux - threshold : 0.0f, bpm, !isOnset };
+        return true;
+    }
+
+    if (isOnset) {
+        if (lost || nextBeat - position <= tolerance) {
+            // Re-anchor on the onset (first beat, or slightly early)
+            lastBeat = samplePosition;
+            lastConfirmed = samplePosition;
+            nextBeat = position + period;
+            event = { samplePosition, flux - threshold, bpm, false };
+            return true;
+        }
+        if (position - (double)lastBeat <= tolerance) {
+            // Late onset right after a predicted beat: correct the phase without a second event
+            lastBeat = samplePosition;
+            lastConfirmed = samplePosition;
+            nextBeat = position + period;
+        }
+    }
+
+    return false;
+}
+
+float BeatTracker::GetPhase(uint64_t samplePosition) const {
+    if (bpm <= 0.0f || samplePosition < lastBeat) return 0.0f;
+    double period = 60.0 * sampleRate / bpm;
+    double phase = (double)(samplePosition - lastBeat) / period;
+    return (float)(phase - floor(phase));
+}
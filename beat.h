@@ -0,0 +1,101 @@
+#ifndef BEAT_H
+#define BEAT_H
+
+#include <cstdint>
+#include "audioring.h"
+
+// =========================================================
+// ONSET + BEAT TRACKER
+// =========================================================
+// Runs once per analysis hop on the magnitude spectrum:
+//   1. Spectral flux (positive magnitude change, bins up to BEAT_MAX_FREQ).
+//   2. Adaptive threshold: running mean + BEAT_THRESHOLD_K * stddev of recent flux,
+//      and at least BEAT_THRESHOLD_RATIO * mean so steady noise never triggers.
+//   3. Leaky autocorrelation of the onset envelope over the 60-200 BPM lag range
+//      (narrower, and logged, when the hop is too short for BEAT_MAX_LAGS to reach 60).
+//   4. Phase tracking: onsets near the predicted beat re-anchor the phase; with no
+//      onset the beat is predicted from the tempo (flywheel).
+// Every step is O(1) or O(bins + lags) per hop.
+
+#define BEAT_MAX_FREQ         8000.0f
+#define BEAT_FLUX_HISTORY     64        // Hops in the adaptive threshold window
+#define BEAT_THRESHOLD_K      2.0f
+#define BEAT_THRESHOLD_RATIO  1.5f      // Onsets must also exceed this multiple of the mean flux
+#define BEAT_FLUX_FLOOR       0.001f    // Ignore flux below this (silence / dither)
+#define BEAT_MIN_BPM          60.0f
+#define BEAT_MAX_BPM          200.0f
+#define BEAT_PRIOR_BPM        120.0f    // Tempo prior that breaks octave ties
+#define BEAT_MAX_LAGS         1024      // 60 BPM down to a 64-sample hop at 48 kHz (lag 750)
+#define BEAT_ACF_DECAY_SEC    8.0f      // Time constant of the autocorrelation memory
+#define BEAT_PHASE_TOLERANCE  0.2f      // Fraction of a period an onset may miss the prediction by
+#define BEAT_FLYWHEEL_BEATS   8         // Predicted beats allowed without a confirming onset
+
+struct BeatEvent {
+    uint64_t samplePosition = 0;    // Input sample index (from stream start) of the hop that fired
+    float strength = 0.0f;          // Onset strength above threshold (0 for predicted beats)
+    float bpm = 0.0f;               // Tempo estimate when the beat fired
+    bool predicted = false;         // True when no onset confirmed the beat
+};
+
+typedef SpscRing<BeatEvent, 64> BeatRing;
+
+class BeatTracker {
+public:
+    BeatTracker();
+    ~BeatTracker();
+
+    // `sampleRate` clocks hops and sample positions; `spectrumRate` is the rate of the
+    // samples the spectrum was computed from (lower after decimation, see decimator.h).
+    void Configure(int bins, int hopSize, float sampleRate, float spectrumRate);
+    void Reset();
+
+    // One hop. `samplePosition` is the input sample index at the end of the hop.
+    // Returns true and fills `event` when a beat fires on this hop.
+    bool Process(const float* magnitude, uint64_t samplePosition, BeatEvent& event);
+
+    int GetBins() const { return bins; }
+    int GetHopSize() const { return hopSize; }
+    float GetSampleRate() const { return sampleRate; }
+    float GetSpectrumRate() const { return spectrumRate; }
+    float GetBPM() const { return bpm; }
+    float GetOnset() const { return onset; }
+
+    // 0 at a beat, rising to 1 just before the next predicted beat.
+    float GetPhase(uint64_t samplePosition) const;
+
+private:
+    void UpdateTempo();
+
+    int bins;
+    int fluxBins;
+    int hopSize;
+    float sampleRate;
+    float spectrumRate;
+    float* previous;
+
+    // Adaptive threshold (running sums over a flux ring)
+    float fluxHistory[BEAT_FLUX_HISTORY];
+    int fluxPos;
+    int fluxCount;
+    double fluxSum;
+    double fluxSumSq;
+
+    // Tempo (leaky autocorrelation of the onset envelope)
+    float onsetHistory[BEAT_MAX_LAGS];
+    int onsetPos;
+    float acf[BEAT_MAX_LAGS];
+    float acfDecay;
+    int minLag;
+    int maxLag;
+    float bpm;
+    float onset;
+    uint64_t hops;
+
+    // Phase
+    uint64_t lastBeat;
+    double nextBeat;
+    uint64_t lastOnset;
+    uint64_t lastConfirmed;
+};
+
+#endif // BEAT_H
@@ -0,0 +1,852 @@
+#include "benchmark.h"
+#include "analysis.h"
+#include "color.h"
+#include "gravityorbs.h"
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define BENCH_SECONDS        30
+#define BENCH_TONE_FREQ      50.0f
+#define BENCH_TONE_AMPLITUDE 0.5f
+
+static const double TWO_PI = 6.283185307179586;
+
+static bool SuiteSelected(const char* suite, const char* name) {
+    return suite == nullptr || suite[0] == '\0' || strcmp(suite, name) == 0;
+}
+
+// =========================================================
+// ANALYSIS
+// =========================================================
+
+struct AnalysisBenchCase {
+    const char* label;
+    AnalysisSettings settings;
+};
+
+// Deterministic test signal: 50 Hz kicks every half second over low-level noise.
+static void FillBenchSignal(std::vector<float>& samples) {
+    unsigned int seed = 12345u;
+    int kickPeriod = DEFAULT_SAMPLE_RATE / 2;
+    for (size_t i = 0; i < samples.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        float noise = ((seed >> 8) / 16777216.0f - 0.5f) * 0.05f;
+        int t = (int)(i % kickPeriod);
+        float envelope = expf(-(float)t / (0.08f * DEFAULT_SAMPLE_RATE));
+        float kick = BENCH_TONE_AMPLITUDE * envelope * sinf((float)(TWO_PI * BENCH_TONE_FREQ * t / DEFAULT_SAMPLE_RATE));
+        samples[i] = kick + noise;
+    }
+}
+
+// Samples from a silence-to-tone step until the unsmoothed bass level reaches half its final value.
+static double MeasureStepLatencyMs(const AnalysisSettings& settings) {
+    SetAnalysisSettings(settings);
+    AudioAnalyzer analyzer;
+    AudioBlock block = {};
+    block.frames = FRAMES_PER_BUFFER;
+
+    int silenceBlocks = 32;
+    int toneBlocks = 64;
+    uint64_t position = 0;
+    uint64_t stepPosition = (uint64_t)silenceBlocks * FRAMES_PER_BUFFER;
+    std::vector<float> levels;
+    std::vector<uint64_t> positions;
+
+    for (int b = 0; b < silenceBlocks + toneBlocks; b++) {
+        for (int i = 0; i < FRAMES_PER_BUFFER; i++, position++) {
+            block.samples[i] = (position < stepPosition) ? 0.0f :
+                BENCH_TONE_AMPLITUDE * (float)sin(TWO_PI * BENCH_TONE_FREQ * (double)(position - stepPosition) / DEFAULT_SAMPLE_RATE);
+        }
+        block.sequence = (uint64_t)b;
+        analyzer.ProcessBlock(block);
+        if (b >= silenceBlocks) {
+            levels.push_back(analyzer.GetSnapshot().bass);
+            positions.push_back(position);
+        }
+    }
+
+    float target = levels.back() * 0.5f;
+    for (size_t i = 0; i < levels.size(); i++) {
+        if (levels[i] >= target) {
+            return (double)(positions[i] - stepPosition) * 1000.0 / DEFAULT_SAMPLE_RATE;
+        }
+    }
+    return -1.0;
+}
+
+static AnalysisSettings DecimatedSettings(int factor) {
+    AnalysisSettings settings;
+    settings.mode = ANALYSIS_DECIMATED;
+    settings.decimation = factor;
+    return settings;
+}
+
+static AnalysisSettings BlockFFTSettings(int fftSize) {
+    AnalysisSettings settings;
+    settings.blockFftSize = fftSize;
+    return settings;
+}
+
+// us per block of the mono mix over the whole signal.
+static double MeasureBlockCostUs(const AnalysisSettings& settings, const std::vector<float>& signal, int blockCount) {
+    SetAnalysisSettings(settings);
+    AudioAnalyzer analyzer;
+    AudioBlock block = {};
+    block.frames = FRAMES_PER_BUFFER;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < blockCount; b++) {
+        memcpy(block.samples, &signal[(size_t)b * FRAMES_PER_BUFFER], sizeof(block.samples));
+        block.sequence = (uint64_t)b;
+        analyzer.ProcessBlock(block);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / blockCount;
+}
+
+static void BenchAnalysis() {
+    AnalysisBenchCase cases[] = {
+        { "Block FFT 512",       { ANALYSIS_BLOCK_FFT,   STFT_DEFAULT_SIZE, STFT_DEFAULT_HOP, WINDOW_HANN } },
+        { "STFT 2048 / 256",     { ANALYSIS_STFT,        2048, 256, WINDOW_HANN } },
+        { "STFT 4096 / 128",     { ANALYSIS_STFT,        4096, 128, WINDOW_HANN } },
+        { "Sliding DFT 4096",    { ANALYSIS_SLIDING_DFT, STFT_DEFAULT_SIZE, STFT_DEFAULT_HOP, WINDOW_HANN } },
+        { "Decimated /8 256",    DecimatedSettings(8) },
+    };
+
+    std::vector<float> signal((size_t)BENCH_SECONDS * DEFAULT_SAMPLE_RATE);
+    FillBenchSignal(signal);
+    int blockCount = (int)(signal.size() / FRAMES_PER_BUFFER);
+    double audioSeconds = (double)blockCount * FRAMES_PER_BUFFER / DEFAULT_SAMPLE_RATE;
+
+    printf("\n[analysis] %d blocks of %d frames (%.1f s of audio)\n", blockCount, FRAMES_PER_BUFFER, audioSeconds);
+    printf("%-20s %12s %12s %12s %14s\n", "mode", "us/block", "x realtime", "results", "step lat. ms");
+
+    for (const AnalysisBenchCase& c : cases) {
+        SetAnalysisSettings(c.settings);
+        AudioAnalyzer analyzer;
+        AudioBlock block = {};
+        block.frames = FRAMES_PER_BUFFER;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < blockCount; b++) {
+            memcpy(block.samples, &signal[(size_t)b * FRAMES_PER_BUFFER], sizeof(block.samples));
+            block.sequence = (uint64_t)b;
+            analyzer.ProcessBlock(block);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%-20s %12.2f %12.0f %12llu %14.2f\n",
+               c.label,
+               seconds * 1e6 / blockCount,
+               audioSeconds / seconds,
+               (unsigned long long)analyzer.GetSnapshot().frames,
+               MeasureStepLatencyMs(c.settings));
+    }
+
+    SetAnalysisSettings(AnalysisSettings());
+}
+
+// =========================================================
+// BLOCK SIZE
+// =========================================================
+// Device block size trades buffering latency against per-block overhead. Every
+// case analyses the same signal with a 512-point block FFT; only the hop changes.
+
+static void BenchBlockSize() {
+    const int blockSizes[] = { 64, 128, 256, 512 };
+
+    std::vector<float> signal((size_t)BENCH_SECONDS * DEFAULT_SAMPLE_RATE);
+    FillBenchSignal(signal);
+    double audioSeconds = (double)signal.size() / DEFAULT_SAMPLE_RATE;
+
+    printf("\n[blocksize] Block FFT %d over %.1f s of audio\n", FFT_SIZE, audioSeconds);
+    printf("%-12s %12s %12s %14s %12s\n", "block", "buffer ms", "us/block", "CPU ms/s", "x realtime");
+
+    for (int blockFrames : blockSizes) {
+        SetAnalysisSettings(AnalysisSettings());
+        AudioAnalyzer analyzer;
+        AudioBlock block = {};
+        block.sampleRate = DEFAULT_SAMPLE_RATE;
+        block.blockFrames = blockFrames;
+        block.frames = (unsigned long)blockFrames;
+        int blockCount = (int)(signal.size() / blockFrames);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < blockCount; b++) {
+            memcpy(block.samples, &signal[(size_t)b * blockFrames], sizeof(float) * blockFrames);
+            block.sequence = (uint64_t)b;
+            analyzer.ProcessBlock(block);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%-12d %12.2f %12.2f %14.2f %12.0f\n",
+               blockFrames,
+               1000.0 * blockFrames / DEFAULT_SAMPLE_RATE,
+               seconds * 1e6 / blockCount,
+               seconds * 1000.0 / audioSeconds,
+               audioSeconds / seconds);
+    }
+
+    SetAnalysisSettings(AnalysisSettings());
+}
+
+// =========================================================
+// DECIMATION
+// =========================================================
+// Decimated mode against the full-rate block FFT that gives the same bass bin width.
+
+static void BenchDecimation() {
+    struct DecimationBenchCase {
+        const char* label;
+        AnalysisSettings settings;
+        float binHz;
+    };
+    DecimationBenchCase cases[] = {
+        { "Block FFT 512",  BlockFFTSettings(512),  (float)DEFAULT_SAMPLE_RATE / 512 },
+        { "Block FFT 2048", BlockFFTSettings(2048), (float)DEFAULT_SAMPLE_RATE / 2048 },
+        { "Decimated /8",   DecimatedSettings(8),   (float)DEFAULT_SAMPLE_RATE / 8 / DECIMATE_FFT_SIZE },
+        { "Block FFT 4096", BlockFFTSettings(4096), (float)DEFAULT_SAMPLE_RATE / 4096 },
+        { "Decimated /16",  DecimatedSettings(16),  (float)DEFAULT_SAMPLE_RATE / 16 / DECIMATE_FFT_SIZE },
+    };
+
+    std::vector<float> signal((size_t)BENCH_SECONDS * DEFAULT_SAMPLE_RATE);
+    FillBenchSignal(signal);
+    int blockCount = (int)(signal.size() / FRAMES_PER_BUFFER);
+    double audioSeconds = (double)blockCount * FRAMES_PER_BUFFER / DEFAULT_SAMPLE_RATE;
+
+    printf("\n[decimate] %d-point FFT after decimation, %d taps per phase, %.1f s of audio\n",
+           DECIMATE_FFT_SIZE, DECIMATE_TAPS_PER_PHASE, audioSeconds);
+    printf("%-20s %10s %12s %12s %14s\n", "mode", "bin Hz", "us/block", "x realtime", "step lat. ms");
+
+    for (const DecimationBenchCase& c : cases) {
+        double us = MeasureBlockCostUs(c.settings, signal, blockCount);
+        printf("%-20s %10.1f %12.2f %12.0f %14.2f\n",
+               c.label, c.binHz, us, audioSeconds * 1e6 / (us * blockCount), MeasureStepLatencyMs(c.settings));
+    }
+
+    SetAnalysisSettings(AnalysisSettings());
+}
+
+// =========================================================
+// AUTO GAIN
+// =========================================================
+// The bench kicks played at a quiet and a loud peak level, with the fixed
+// normalisation and with auto gain. Glow and bass are read over the last
+// AUTOGAIN_BENCH_MEASURE_SEC, once the gain trackers have settled.
+
+#define AUTOGAIN_BENCH_MEASURE_SEC 10
+
+struct LevelRange {
+    float low;      // 5th percentile
+    float high;     // 95th percentile
+};
+
+static LevelRange PercentileRange(std::vector<float>& values) {
+    std::sort(values.begin(), values.end());
+    LevelRange range = { values[values.size() / 20], values[values.size() * 19 / 20] };
+    return range;
+}
+
+static void BenchAutoGain() {
+    const float levelsDb[] = { -30.0f, -1.0f };
+
+    std::vector<float> reference((size_t)BENCH_SECONDS * DEFAULT_SAMPLE_RATE);
+    FillBenchSignal(reference);
+    int blockCount = (int)(reference.size() / FRAMES_PER_BUFFER);
+    int measureFrom = blockCount - AUTOGAIN_BENCH_MEASURE_SEC * DEFAULT_SAMPLE_RATE / FRAMES_PER_BUFFER;
+
+    printf("\n[autogain] 50 Hz kicks at two peak levels, glow / bass p5..p95 over the last %d s of %d s\n",
+           AUTOGAIN_BENCH_MEASURE_SEC, BENCH_SECONDS);
+    printf("%-10s %8s %18s %18s\n", "gain", "dBFS", "glow p5..p95", "bass p5..p95");
+
+    for (int autoGain = 0; autoGain <= 1; autoGain++) {
+        LevelRange glowRanges[2];
+        for (int l = 0; l < 2; l++) {
+            float scale = powf(10.0f, levelsDb[l] / 20.0f) / BENCH_TONE_AMPLITUDE;
+            AnalysisSettings settings;
+            settings.autoGain = autoGain != 0;
+            SetAnalysisSettings(settings);
+
+            AudioAnalyzer analyzer;
+            AudioBlock block = {};
+            block.frames = FRAMES_PER_BUFFER;
+            std::vector<float> glow, bass;
+            for (int b = 0; b < blockCount; b++) {
+                for (int i = 0; i < FRAMES_PER_BUFFER; i++) block.samples[i] = reference[(size_t)b * FRAMES_PER_BUFFER + i] * scale;
+                block.sequence = (uint64_t)b;
+                analyzer.ProcessBlock(block);
+                if (b < measureFrom) continue;
+                glow.push_back(analyzer.GetSnapshot().glow);
+                bass.push_back(analyzer.GetSnapshot().bass);
+            }
+            glowRanges[l] = PercentileRange(glow);
+            LevelRange bassRange = PercentileRange(bass);
+            printf("%-10s %8.0f %8.3f..%-8.3f %8.3f..%-8.3f\n", autoGain ? "auto" : "fixed", levelsDb[l],
+                   glowRanges[l].low, glowRanges[l].high, bassRange.low, bassRange.high);
+        }
+        float ratio = glowRanges[0].high > 0.0f ? glowRanges[1].high / glowRanges[0].high : 0.0f;
+        printf("%-10s glow p95 ratio loud / quiet: %.2f\n", autoGain ? "auto" : "fixed", ratio);
+    }
+
+    SetAnalysisSettings(AnalysisSettings());
+}
+
+// =========================================================
+// FILTERBANK
+// =========================================================
+// Cost of one filterbank pass against the FFT that feeds it, on the same spectrum.
+
+#define FILTERBANK_BENCH_REPEATS 20000
+
+// Keeps the optimiser from dropping the timed loops
+static volatile float benchSink;
+
+static void BenchFilterbank() {
+    const int fftSizes[] = { 512, 2048, 4096 };
+    const int scales[] = { FILTERBANK_MEL, FILTERBANK_CQT };
+    const int bandCounts[] = { FILTERBANK_MIN_BANDS, FILTERBANK_DEFAULT_BANDS, FILTERBANK_MAX_BANDS };
+
+    std::vector<float> signal(4096);
+    FillBenchSignal(signal);
+
+    printf("\n[filterbank] %d passes per case at %d Hz\n", FILTERBANK_BENCH_REPEATS, DEFAULT_SAMPLE_RATE);
+    printf("%-8s %-12s %8s %10s %12s %12s %10s\n", "fft", "scale", "bands", "weights", "fft us", "bank us", "bank/fft");
+
+    for (int fftSize : fftSizes) {
+        FFTSpectrum spectrum;
+        if (!AllocSpectrum(spectrum, fftSize)) continue;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < FILTERBANK_BENCH_REPEATS; r++) {
+            ComputeSpectrum(spectrum, signal.data(), fftSize);
+        }
+        double fftUs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / FILTERBANK_BENCH_REPEATS;
+
+        for (int scale : scales) {
+            for (int bands : bandCounts) {
+                Filterbank bank;
+                BuildFilterbank(bank, scale, bands, fftSize, (float)DEFAULT_SAMPLE_RATE);
+                float levels[FILTERBANK_MAX_BANDS];
+                float checksum = 0.0f;
+
+                start = std::chrono::steady_clock::now();
+                for (int r = 0; r < FILTERBANK_BENCH_REPEATS; r++) {
+                    ApplyFilterbank(bank, spectrum.magnitude, levels);
+                    checksum += levels[r % bank.bands];
+                }
+                double bankUs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / FILTERBANK_BENCH_REPEATS;
+
+                benchSink = checksum;
+
+                printf("%-8d %-12s %8d %10d %12.2f %12.2f %9.1f%%\n",
+                       fftSize, GetFilterbankScaleName(scale), bank.bands, (int)bank.weights.size(),
+                       fftUs, bankUs, 100.0 * bankUs / fftUs);
+            }
+        }
+        FreeSpectrum(spectrum);
+    }
+}
+
+// =========================================================
+// COLOR
+// =========================================================
+// HSV conversion of one particle field per frame: the old branchy per-call
+// converter against the shared table, one call at a time and batched.
+
+#define COLOR_BENCH_COUNT   200000
+#define COLOR_BENCH_REPEATS 50
+
+static Color ReferenceHSVToColor(float h, float s, float v) {
+    float r, g, b;
+    int i = (int)(h * 6.0f);
+    float f = h * 6.0f - i;
+    float p = v * (1.0f - s);
+    float q = v * (1.0f - f * s);
+    float t = v * (1.0f - (1.0f - f) * s);
+    switch (i % 6) {
+        case 0: r = v; g = t; b = p; break;
+        case 1: r = q; g = v; b = p; break;
+        case 2: r = p; g = v; b = t; break;
+        case 3: r = p; g = q; b = v; break;
+        case 4: r = t; g = p; b = v; break;
+        default: r = v; g = p; b = q; break;
+    }
+    return (Color){ (unsigned char)(r * 255), (unsigned char)(g * 255), (unsigned char)(b * 255), 255 };
+}
+
+static void BenchColor() {
+    std::vector<float> h(COLOR_BENCH_COUNT), s(COLOR_BENCH_COUNT), v(COLOR_BENCH_COUNT);
+    std::vector<Color> out(COLOR_BENCH_COUNT);
+    unsigned int seed = 12345u;
+    for (int i = 0; i < COLOR_BENCH_COUNT; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        h[i] = (seed >> 8) / 16777216.0f;
+        s[i] = 0.5f + 0.5f * (float)(i % 7) / 6.0f;
+        v[i] = 0.4f + 0.6f * (float)(i % 11) / 10.0f;
+    }
+
+    printf("\n[color] %d conversions x %d frames\n", COLOR_BENCH_COUNT, COLOR_BENCH_REPEATS);
+    printf("%-20s %12s %12s\n", "converter", "ns/color", "max error");
+
+    for (int method = 0; method < 3; method++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < COLOR_BENCH_REPEATS; r++) {
+            if (method == 2) {
+                HSVToColorBatch(h.data(), s.data(), v.data(), out.data(), COLOR_BENCH_COUNT);
+                continue;
+            }
+            for (int i = 0; i < COLOR_BENCH_COUNT; i++) {
+                out[i] = (method == 0) ? ReferenceHSVToColor(h[i], s[i], v[i]) : HSVToColor(h[i], s[i], v[i]);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int maxError = 0;
+        for (int i = 0; i < COLOR_BENCH_COUNT; i++) {
+            Color expected = ReferenceHSVToColor(h[i], s[i], v[i]);
+            maxError = std::max(maxError, std::abs((int)out[i].r - (int)expected.r));
+            maxError = std::max(maxError, std::abs((int)out[i].g - (int)expected.g));
+            maxError = std::max(maxError, std::abs((int)out[i].b - (int)expected.b));
+        }
+
+        const char* labels[] = { "Scalar (old)", "Table", "Table batch" };
+        printf("%-20s %12.2f %12d\n", labels[method],
+               seconds * 1e9 / ((double)COLOR_BENCH_COUNT * COLOR_BENCH_REPEATS), maxError);
+    }
+}
+
+// =========================================================
+// SPECTROGRAM
+// =========================================================
+// Cost of quantizing one spectrum into the history ring, its worst level error
+// against an exact log10 quantizer, and the texture bytes each hop sends compared
+// with rebuilding the whole image.
+
+#define SPECTROGRAM_BENCH_REPEATS 20000
+
+static void BenchSpectrogram() {
+    const int fftSizes[] = { 512, 2048, 4096 };
+
+    std::vector<float> signal(4096);
+    FillBenchSignal(signal);
+
+    printf("\n[spectrogram] %d x %d ring, %d columns per case\n", SPECTROGRAM_COLUMNS, SPECTROGRAM_ROWS, SPECTROGRAM_BENCH_REPEATS);
+    printf("%-8s %12s %12s %14s %14s\n", "fft", "push us", "max error", "upload bytes", "rebuild bytes");
+
+    for (int fftSize : fftSizes) {
+        FFTSpectrum spectrum;
+        if (!AllocSpectrum(spectrum, fftSize)) continue;
+        ComputeSpectrum(spectrum, signal.data(), fftSize);
+        // Same FFT_SIZE reference as the analysis path
+        float scale = (float)FFT_SIZE / (float)fftSize;
+        for (int b = 0; b < spectrum.bins; b++) spectrum.magnitude[b] *= scale;
+
+        SpectrogramRing ring;
+        float binHz = (float)DEFAULT_SAMPLE_RATE / (float)fftSize;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < SPECTROGRAM_BENCH_REPEATS; r++) {
+            ring.PushColumn(spectrum.magnitude, spectrum.bins, binHz);
+        }
+        double pushUs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / SPECTROGRAM_BENCH_REPEATS;
+
+        // Reference: exact dB of the same per-row peak (rows are read back through GetRowFreq)
+        const uint8_t* column = ring.GetColumn((int)((ring.GetWritten() - 1) % SPECTROGRAM_COLUMNS));
+        float maxError = 0.0f;
+        for (int row = 0; row < SPECTROGRAM_ROWS; row++) {
+            int first = (int)ceilf(ring.GetRowFreq(row) / binHz);
+            int last = std::min((int)ceilf(ring.GetRowFreq(row + 1) / binHz), spectrum.bins);
+            if (first >= last) {
+                first = std::min((int)(ring.GetRowFreq(row) / binHz), spectrum.bins - 1);
+                last = first + 1;
+            }
+            float peak = 1e-9f;
+            for (int b = first; b < last; b++) peak = std::max(peak, spectrum.magnitude[b]);
+            float db = 20.0f * log10f(peak / (FFT_SIZE * 0.5f));
+            float level = std::clamp((db - SPECTROGRAM_FLOOR_DB) * 255.0f / SPECTROGRAM_RANGE_DB, 0.0f, 255.0f);
+            maxError = std::max(maxError, fabsf(level - (float)column[row]));
+        }
+
+        printf("%-8d %12.3f %12.2f %14d %14d\n", fftSize, pushUs, maxError,
+               SPECTROGRAM_ROWS, SPECTROGRAM_COLUMNS * SPECTROGRAM_ROWS);
+        FreeSpectrum(spectrum);
+    }
+}
+
+// =========================================================
+// ORBS
+// =========================================================
+// One gravity-mode frame: the old array-of-structs loop against the SoA kernel.
+// Both start from the same field and re-place sucked orbs the same way, so the
+// final positions must agree.
+
+#define ORB_BENCH_WIDTH   1920.0f
+#define ORB_BENCH_HEIGHT  1080.0f
+#define ORB_BENCH_ORBS    20000000    // Orb updates per case (frames = this / orbs)
+
+struct ReferenceOrb {
+    Vector2 pos;
+    float radius;
+    int opacity;
+    Color color;
+};
+
+// Deterministic stand-in for RespawnOrb (which draws from raylib's RNG and screen size).
+static Vector2 BenchRespawnPosition(int index) {
+    return (Vector2){ -40.0f, (float)(index % (int)ORB_BENCH_HEIGHT) };
+}
+
+static void ReferenceUpdateOrbs(std::vector<ReferenceOrb>& orbs, const OrbStep& step, float intensity, Color orbColor) {
+    for (size_t i = 0; i < orbs.size(); i++) {
+        ReferenceOrb* orb = &orbs[i];
+
+        float dx = step.center.x - orb->pos.x;
+        float dy = step.center.y - orb->pos.y;
+        float dist = sqrtf(dx * dx + dy * dy);
+        if (dist == 0) dist = 1;
+        dx *= 1.0f / dist;
+        dy *= 1.0f / dist;
+        orb->pos.x += dx * step.pullStrength;
+        orb->pos.y += dy * step.pullStrength;
+
+        if (step.mouseActive) {
+            float mx = orb->pos.x - step.mouse.x;
+            float my = orb->pos.y - step.mouse.y;
+            float mouseDist = sqrtf(mx * mx + my * my);
+            if (mouseDist < 250.0f) {
+                float length = sqrtf(mx * mx + my * my);
+                if (length > 0.0f) {
+                    float repelStrength = (1.0f - (mouseDist / 250.0f)) * step.repelForce;
+                    orb->pos.x += mx * (1.0f / length) * repelStrength;
+                    orb->pos.y += my * (1.0f / length) * repelStrength;
+                }
+            }
+        }
+
+        float cx = orb->pos.x - step.center.x;
+        float cy = orb->pos.y - step.center.y;
+        if (sqrtf(cx * cx + cy * cy) < 40.0f) {
+            orb->pos = BenchRespawnPosition((int)i);
+        }
+
+        orb->radius = 5.0f + intensity * 20.0f;
+        orb->opacity = (int)(intensity * 255);
+        orb->color = orbColor;
+    }
+}
+
+static void BenchOrbs() {
+    const int counts[] = { 1250, 100000, 500000 };
+
+    OrbStep step;
+    step.center = (Vector2){ ORB_BENCH_WIDTH / 2.0f, ORB_BENCH_HEIGHT / 2.0f };
+    step.mouse = (Vector2){ ORB_BENCH_WIDTH * 0.3f, ORB_BENCH_HEIGHT * 0.4f };
+    step.mouseActive = true;
+    step.pullStrength = 18.0f * 0.6f;
+    step.repelForce = 5.0f;
+
+    printf("\n[orbs] %d orb updates per case, %.0f x %.0f screen, mouse inside\n", ORB_BENCH_ORBS, ORB_BENCH_WIDTH, ORB_BENCH_HEIGHT);
+    printf("%-10s %8s %14s %14s %10s %12s\n", "orbs", "frames", "AoS ns/orb", "SoA ns/orb", "speedup", "max diff");
+
+    for (int count : counts) {
+        int frames = std::max(1, ORB_BENCH_ORBS / count);
+        std::vector<ReferenceOrb> reference(count);
+        float* x = AllocAlignedFloats(count);
+        float* y = AllocAlignedFloats(count);
+        std::vector<int> sucked(count);
+        if (!x || !y) {
+            FreeAligned(x);
+            FreeAligned(y);
+            continue;
+        }
+
+        unsigned int seed = 12345u;
+        for (int i = 0; i < count; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            float u = (seed >> 8) / 16777216.0f;
+            seed = seed * 1664525u + 1013904223u;
+            float v = (seed >> 8) / 16777216.0f;
+            reference[i].pos = (Vector2){ u * ORB_BENCH_WIDTH, v * ORB_BENCH_HEIGHT };
+            x[i] = reference[i].pos.x;
+            y[i] = reference[i].pos.y;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            ReferenceUpdateOrbs(reference, step, 0.6f, WHITE);
+        }
+        double aosSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            int n = StepOrbs(x, y, count, step, sucked.data());
+            for (int s = 0; s < n; s++) {
+                Vector2 p = BenchRespawnPosition(sucked[s]);
+                x[sucked[s]] = p.x;
+                y[sucked[s]] = p.y;
+            }
+        }
+        double soaSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        float maxDiff = 0.0f;
+        for (int i = 0; i < count; i++) {
+            maxDiff = std::max(maxDiff, fabsf(reference[i].pos.x - x[i]));
+            maxDiff = std::max(maxDiff, fabsf(reference[i].pos.y - y[i]));
+        }
+
+        double updates = (double)frames * count;
+        printf("%-10d %8d %14.2f %14.2f %9.1fx %12.3g\n", count, frames,
+               aosSeconds * 1e9 / updates, soaSeconds * 1e9 / updates, aosSeconds / soaSeconds, maxDiff);
+        FreeAligned(x);
+        FreeAligned(y);
+    }
+}
+
+// =========================================================
+// ORB THREADS
+// =========================================================
+// StepOrbsParallel from one thread up to every core, deterministic streams, so
+// each thread count must end with the same field as the single-threaded run.
+
+#define ORB_THREAD_BENCH_ORBS  40000000   // Orb updates per case (frames = this / orbs)
+
+static void BenchOrbThreads() {
+    const int counts[] = { 10000, 100000, 1000000 };
+    int cores = std::min(std::max((int)std::thread::hardware_concurrency(), 1), WORKER_POOL_MAX_THREADS);
+
+    std::vector<int> threadCounts;
+    for (int t = 1; t < cores; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(cores);
+
+    OrbStep step;
+    step.center = (Vector2){ ORB_BENCH_WIDTH / 2.0f, ORB_BENCH_HEIGHT / 2.0f };
+    step.mouse = (Vector2){ ORB_BENCH_WIDTH * 0.3f, ORB_BENCH_HEIGHT * 0.4f };
+    step.mouseActive = true;
+    step.pullStrength = 18.0f * 0.6f;
+    step.repelForce = 5.0f;
+    step.screen = (Vector2){ ORB_BENCH_WIDTH, ORB_BENCH_HEIGHT };
+
+    printf("\n[orbthreads] %d orb updates per case, %d-orb chunks, %d cores\n", ORB_THREAD_BENCH_ORBS, ORB_CHUNK, cores);
+    printf("%-10s %8s %8s %12s %12s %10s %6s\n", "orbs", "threads", "frames", "ms/frame", "ns/orb", "speedup", "same");
+
+    for (int count : counts) {
+        int frames = std::max(4, ORB_THREAD_BENCH_ORBS / count);
+        float* x = AllocAlignedFloats(count);
+        float* y = AllocAlignedFloats(count);
+        std::vector<int> sucked(count);
+        std::vector<float> reference;
+        if (!x || !y) {
+            FreeAligned(x);
+            FreeAligned(y);
+            continue;
+        }
+
+        double serialSeconds = 0.0;
+        for (int threads : threadCounts) {
+            unsigned int seed = 12345u;
+            for (int i = 0; i < count; i++) {
+                seed = seed * 1664525u + 1013904223u;
+                x[i] = (seed >> 8) / 16777216.0f * ORB_BENCH_WIDTH;
+                seed = seed * 1664525u + 1013904223u;
+                y[i] = (seed >> 8) / 16777216.0f * ORB_BENCH_HEIGHT;
+            }
+
+            WorkerPool pool;
+            pool.Start(threads);
+            auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < frames; f++) {
+                StepOrbsParallel(x, y, count, step, sucked.data(), pool, true, (uint32_t)f);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            pool.Stop();
+
+            bool same = true;
+            if (reference.empty()) {
+                serialSeconds = seconds;
+                reference.assign(x, x + count);
+                reference.insert(reference.end(), y, y + count);
+            } else {
+                same = memcmp(reference.data(), x, sizeof(float) * count) == 0 &&
+                       memcmp(reference.data() + count, y, sizeof(float) * count) == 0;
+            }
+
+            printf("%-10d %8d %8d %12.3f %12.2f %9.2fx %6s\n", count, threads, frames, seconds * 1e3 / frames,
+                   seconds * 1e9 / ((double)frames * count), serialSeconds / seconds, same ? "yes" : "NO");
+        }
+        FreeAligned(x);
+        FreeAligned(y);
+    }
+}
+
+// =========================================================
+// ORB GRID
+// =========================================================
+// Counting-sort rebuild and each interaction mode on one thread, against the
+// all-pairs scan they replace (only run where it finishes in reasonable time).
+// The grid's radius query must find exactly the pairs the scan finds, and the
+// grid mouse repel must move orbs exactly like the per-orb loop.
+
+#define ORB_GRID_BENCH_FRAMES   20
+#define ORB_GRID_BENCH_BRUTE    10000   // Largest field the all-pairs scan runs on
+
+static void BenchOrbGrid() {
+    const int counts[] = { 10000, 50000, 200000 };
+    const float radius = 60.0f;
+    const float margin = 40.0f;
+
+    OrbStep step;
+    step.center = (Vector2){ ORB_BENCH_WIDTH / 2.0f, ORB_BENCH_HEIGHT / 2.0f };
+    step.mouse = (Vector2){ ORB_BENCH_WIDTH * 0.3f, ORB_BENCH_HEIGHT * 0.4f };
+    step.mouseActive = true;
+    step.pullStrength = 0.0f;
+    step.repelForce = 5.0f;
+    step.screen = (Vector2){ ORB_BENCH_WIDTH, ORB_BENCH_HEIGHT };
+
+    printf("\n[orbgrid] %d frames per case, %.0f px neighbour radius, one thread\n", ORB_GRID_BENCH_FRAMES, radius);
+    printf("%-8s %10s %10s %10s %10s %10s %12s %8s %10s\n", "orbs", "build ns", "flock ns", "collide ns", "clump ns",
+           "repel ns", "all-pairs ms", "pairs", "repel diff");
+
+    WorkerPool pool;
+    OrbGrid grid;
+    for (int count : counts) {
+        std::vector<float> x0(count), y0(count), x(count), y(count);
+        unsigned int seed = 12345u;
+        for (int i = 0; i < count; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            x0[i] = (seed >> 8) / 16777216.0f * ORB_BENCH_WIDTH;
+            seed = seed * 1664525u + 1013904223u;
+            y0[i] = (seed >> 8) / 16777216.0f * ORB_BENCH_HEIGHT;
+        }
+        double perOrb = 1e9 / ((double)ORB_GRID_BENCH_FRAMES * count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < ORB_GRID_BENCH_FRAMES; f++) {
+            grid.Build(x0.data(), y0.data(), count, radius, -margin, -margin, ORB_BENCH_WIDTH + margin, ORB_BENCH_HEIGHT + margin);
+        }
+        double buildNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * perOrb;
+
+        double modeNs[ORB_INTERACTION_COUNT] = { 0.0 };
+        for (int mode = ORB_INTERACT_FLOCK; mode < ORB_INTERACTION_COUNT; mode++) {
+            OrbInteract params = { mode, radius, 20.0f, 0.8f, 0 };
+            x = x0;
+            y = y0;
+            start = std::chrono::steady_clock::now();
+            for (int f = 0; f < ORB_GRID_BENCH_FRAMES; f++) {
+                params.frame = (uint32_t)f;
+                InteractOrbs(x.data(), y.data(), grid, params, pool);
+            }
+            modeNs[mode] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * perOrb;
+        }
+
+        // Repel through the grid against the per-orb loop (pull off, so only the repel moves orbs)
+        x = x0;
+        y = y0;
+        start = std::chrono::steady_clock::now();
+        for (int f = 0; f < ORB_GRID_BENCH_FRAMES; f++) {
+            RepelOrbs(x.data(), y.data(), grid, step);
+        }
+        double repelNs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * perOrb;
+
+        std::vector<float> rx = x0, ry = y0;
+        for (int f = 0; f < ORB_GRID_BENCH_FRAMES; f++) {
+            for (int i = 0; i < count; i++) {
+                float mx = x0[i] - step.mouse.x, my = y0[i] - step.mouse.y;
+                float mouseDist = sqrtf(mx * mx + my * my);
+                if (mouseDist < 250.0f && mouseDist > 0.0f) {
+                    float repelStrength = (1.0f - (mouseDist / 250.0f)) * step.repelForce;
+                    rx[i] += mx * (1.0f / mouseDist) * repelStrength;
+                    ry[i] += my * (1.0f / mouseDist) * repelStrength;
+                }
+            }
+        }
+        float repelDiff = 0.0f;
+        for (int i = 0; i < count; i++) {
+            repelDiff = std::max(repelDiff, std::max(fabsf(rx[i] - x[i]), fabsf(ry[i] - y[i])));
+        }
+
+        char bruteText[32] = "-";
+        char pairsText[16] = "-";
+        if (count <= ORB_GRID_BENCH_BRUTE) {
+            long long brutePairs = 0;
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < count; i++) {
+                for (int j = 0; j < count; j++) {
+                    float dx = x0[j] - x0[i], dy = y0[j] - y0[i];
+                    if (j != i && dx * dx + dy * dy < radius * radius) brutePairs++;
+                }
+            }
+            double bruteMs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3;
+
+            long long gridPairs = 0;
+            for (int i = 0; i < count; i++) {
+                grid.QueryRadius(x0[i], y0[i], radius, [&](int slot, float, float, float) {
+                    if (grid.GetOrder()[slot] != i) gridPairs++;
+                });
+            }
+            snprintf(bruteText, sizeof(bruteText), "%.1f", bruteMs);
+            snprintf(pairsText, sizeof(pairsText), "%s", gridPairs == brutePairs ? "same" : "DIFF");
+        }
+
+        printf("%-8d %10.1f %10.1f %10.1f %10.1f %10.1f %12s %8s %10.3g\n", count, buildNs, modeNs[ORB_INTERACT_FLOCK],
+               modeNs[ORB_INTERACT_COLLIDE], modeNs[ORB_INTERACT_CLUMP], repelNs, bruteText, pairsText, repelDiff);
+    }
+}
+
+// =========================================================
+// ENTRY POINT
+// =========================================================
+
+int RunBenchmarks(const char* suite) {
+    bool ran = false;
+
+    if (SuiteSelected(suite, "analysis")) {
+        BenchAnalysis();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "blocksize")) {
+        BenchBlockSize();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "decimate")) {
+        BenchDecimation();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "autogain")) {
+        BenchAutoGain();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "filterbank")) {
+        BenchFilterbank();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "color")) {
+        BenchColor();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "spectrogram")) {
+        BenchSpectrogram();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "orbs")) {
+        BenchOrbs();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "orbthreads")) {
+        BenchOrbThreads();
+        ran = true;
+    }
+    if (SuiteSelected(suite, "orbgrid")) {
+        BenchOrbGrid();
+        ran = true;
+    }
+
+    if (!ran) {
+        fprintf(stderr, "Unknown benchmark suite '%s'\n", suite);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// =========================================================
+// BUILT-IN BENCHMARKS
+// =========================================================
+// Run with `VisualBassSync --bench [suite]`. No window or audio device is opened;
+// results are printed to stdout. Without a suite name every suite runs.
+//
+//   analysis   CPU cost and step latency of each AnalysisMode
+//   blocksize  CPU cost of each device block size at a fixed analysis size
+//   decimate   Decimated mode against the full-rate FFT of the same bass resolution
+//   autogain   Glow range of -30 and -1 dBFS kicks with the fixed normalisation and with auto gain
+//   filterbank Mel / constant-Q filterbank cost next to the FFT it reads
+//   color      HSV -> RGB conversion: old scalar code against the shared table
+//   spectrogram Spectrogram column quantizing and per-hop texture upload size
+//   orbs       Gravity-mode orb update: old array-of-structs loop against the SIMD kernel
+//   orbthreads Parallel orb update from 1 to every core at 10k / 100k / 1M orbs
+//   orbgrid    Spatial grid rebuild, interaction modes and grid mouse repel against all-pairs scans
+
+int RunBenchmarks(const char* suite);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,431 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NOGDI
+#define NOUSER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "capture.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+
+static_assert(sizeof(CaptureHeader) % CAPTURE_ALIGNMENT == 0, "CaptureHeader must keep records aligned");
+static_assert(sizeof(CaptureRecord) % CAPTURE_ALIGNMENT == 0, "CaptureRecord must keep payloads aligned");
+static_assert(sizeof(CaptureAudio) % CAPTURE_ALIGNMENT == 0, "CaptureAudio must keep samples aligned");
+
+static uint64_t PaddedSize(uint64_t bytes) {
+    return (bytes + CAPTURE_ALIGNMENT - 1) & ~(uint64_t)(CAPTURE_ALIGNMENT - 1);
+}
+
+static void FillHeader(CaptureHeader& header) {
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = CAPTURE_VERSION;
+    header.headerSize = sizeof(CaptureHeader);
+    header.snapshotSize = sizeof(AnalysisSnapshot);
+    header.settingsSize = sizeof(AnalysisSettings);
+}
+
+// =========================================================
+// RECORDING
+// =========================================================
+
+struct CaptureWriter {
+    FILE* file = nullptr;
+    char* buffer = nullptr;
+    CaptureHeader header;
+    std::vector<CaptureIndexEntry> index;
+    uint64_t offset = 0;
+    uint64_t lastGeneration = 0;
+    bool settingsWritten = false;
+    bool timeValid = false;
+    double firstTime = 0.0;
+    float planes[MAX_AUDIO_CHANNELS * FRAMES_PER_BUFFER];
+};
+
+static std::mutex captureMutex;
+static CaptureWriter* captureWriter = nullptr;
+static std::atomic<bool> captureActive(false);
+static std::atomic<uint64_t> captureBlocks(0);
+
+static bool WriteRecord(CaptureWriter& writer, uint32_t type, uint64_t sequence, double time,
+                        const void* first, size_t firstSize, const void* second, size_t secondSize) {
+    static const uint8_t padding[CAPTURE_ALIGNMENT] = {};
+    CaptureRecord record;
+    record.type = type;
+    record.size = (uint32_t)(firstSize + secondSize);
+    record.sequence = sequence;
+    record.time = time;
+    size_t pad = (size_t)(PaddedSize(record.size) - record.size);
+
+    if (fwrite(&record, sizeof(record), 1, writer.file) != 1) return false;
+    if (firstSize > 0 && fwrite(first, firstSize, 1, writer.file) != 1) return false;
+    if (secondSize > 0 && fwrite(second, secondSize, 1, writer.file) != 1) return false;
+    if (pad > 0 && fwrite(padding, pad, 1, writer.file) != 1) return false;
+
+    CaptureIndexEntry entry = { writer.offset, type, 0 };
+    writer.index.push_back(entry);
+    writer.offset += sizeof(record) + PaddedSize(record.size);
+    writer.header.recordCount++;
+    return true;
+}
+
+// Index and final counts, then the header again at the start of the file.
+static bool FinishCapture(CaptureWriter& writer) {
+    bool ok = true;
+    if (!writer.index.empty()) {
+        ok = fwrite(writer.index.data(), sizeof(CaptureIndexEntry), writer.index.size(), writer.file) == writer.index.size();
+    }
+    if (ok) {
+        writer.header.indexOffset = writer.offset;
+        ok = fseek(writer.file, 0, SEEK_SET) == 0 && fwrite(&writer.header, sizeof(writer.header), 1, writer.file) == 1;
+    }
+    if (fclose(writer.file) != 0) ok = false;
+    writer.file = nullptr;
+    return ok;
+}
+
+bool StartCaptureRecording(const char* path) {
+    std::lock_guard<std::mutex> lock(captureMutex);
+    if (captureWriter) return false;
+
+    CaptureWriter* writer = new CaptureWriter();
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        fprintf(stderr, "Cannot create capture '%s'\n", path);
+        delete writer;
+        return false;
+    }
+    writer->buffer = (char*)malloc(CAPTURE_WRITE_BUFFER);
+    if (writer->buffer) setvbuf(writer->file, writer->buffer, _IOFBF, CAPTURE_WRITE_BUFFER);
+
+    FillHeader(writer->header);
+    writer->header.createdUnix = (int64_t)time(nullptr);
+    if (fwrite(&writer->header, sizeof(writer->header), 1, writer->file) != 1) {
+        fprintf(stderr, "Cannot write capture '%s'\n", path);
+        fclose(writer->file);
+        free(writer->buffer);
+        delete writer;
+        return false;
+    }
+    writer->offset = sizeof(CaptureHeader);
+
+    captureWriter = writer;
+    captureBlocks.store(0, std::memory_order_relaxed);
+    captureActive.store(true, std::memory_order_release);
+    return true;
+}
+
+void StopCaptureRecording() {
+    std::lock_guard<std::mutex> lock(captureMutex);
+    captureActive.store(false, std::memory_order_release);
+    if (!captureWriter) return;
+    if (captureWriter->file && !FinishCapture(*captureWriter)) {
+        fprintf(stderr, "Capture index could not be written; the file is still readable without it\n");
+    }
+    free(captureWriter->buffer);
+    delete captureWriter;
+    captureWriter = nullptr;
+}
+
+bool IsCaptureRecording() {
+    return captureActive.load(std::memory_order_acquire);
+}
+
+uint64_t GetCaptureRecordedBlocks() {
+    return captureBlocks.load(std::memory_order_relaxed);
+}
+
+void CaptureAnalysedBlock(const AudioBlock& block, const AnalysisSnapshot& snapshot,
+                          const AnalysisSettings& settings, uint64_t settingsGeneration) {
+    if (!captureActive.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(captureMutex);
+    CaptureWriter* writer = captureWriter;
+    if (!writer || !writer->file) return;
+
+    if (!writer->timeValid) {
+        writer->firstTime = block.captureTime;
+        writer->timeValid = true;
+    }
+    double time = block.captureTime - writer->firstTime;
+
+    // Mono blocks only carry `samples`; wider ones keep the untouched input in `planes`
+    CaptureAudio audio;
+    audio.frames = (uint32_t)std::min<unsigned long>(block.frames, FRAMES_PER_BUFFER);
+    audio.channels = block.channels > 1 ? block.channels : 1;
+    audio.sampleRate = block.sampleRate > 0 ? block.sampleRate : DEFAULT_SAMPLE_RATE;
+    audio.blockFrames = block.blockFrames > 0 ? block.blockFrames : (int32_t)audio.frames;
+    size_t planeBytes = sizeof(float) * audio.frames;
+    if (audio.channels == 1) {
+        memcpy(writer->planes, block.samples, planeBytes);
+    } else {
+        for (int c = 0; c < audio.channels; c++) memcpy(writer->planes + (size_t)c * audio.frames, block.planes[c], planeBytes);
+    }
+
+    bool ok = true;
+    if (!writer->settingsWritten || settingsGeneration != writer->lastGeneration) {
+        ok = WriteRecord(*writer, CAPTURE_RECORD_SETTINGS, block.sequence, time, &settings, sizeof(settings), nullptr, 0);
+        writer->lastGeneration = settingsGeneration;
+        writer->settingsWritten = true;
+    }
+    ok = ok && WriteRecord(*writer, CAPTURE_RECORD_AUDIO, block.sequence, time, &audio, sizeof(audio),
+                           writer->planes, planeBytes * audio.channels);
+    ok = ok && WriteRecord(*writer, CAPTURE_RECORD_SNAPSHOT, block.sequence, time, &snapshot, sizeof(snapshot), nullptr, 0);
+
+    if (!ok) {
+        // Disk full or gone: keep what was written (it can be walked without an index) and stop
+        fprintf(stderr, "Capture write failed; recording stopped after %llu blocks\n",
+                (unsigned long long)writer->header.blockCount);
+        fclose(writer->file);
+        writer->file = nullptr;
+        captureActive.store(false, std::memory_order_release);
+        return;
+    }
+    writer->header.blockCount++;
+    writer->header.frameCount += audio.frames;
+    captureBlocks.store(writer->header.blockCount, std::memory_order_relaxed);
+}
+
+// =========================================================
+// READING
+// =========================================================
+
+#ifdef _WIN32
+CaptureFile::CaptureFile() : base(nullptr), size(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+#else
+CaptureFile::CaptureFile() : base(nullptr), size(0), fd(-1) {}
+#endif
+
+CaptureFile::~CaptureFile() {
+    Close();
+}
+
+bool CaptureFile::Open(const char* path) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        fprintf(stderr, "Cannot open capture '%s'\n", path);
+        return false;
+    }
+    fileHandle = file;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(CaptureHeader)) {
+        fprintf(stderr, "'%s' is not a capture\n", path);
+        Close();
+        return false;
+    }
+    size = (size_t)fileSize.QuadPart;
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle) base = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open capture '%s'\n", path);
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(CaptureHeader)) {
+        fprintf(stderr, "'%s' is not a capture\n", path);
+        Close();
+        return false;
+    }
+    size = (size_t)info.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) base = (const uint8_t*)mapped;
+#endif
+    if (!base) {
+        fprintf(stderr, "Cannot map capture '%s'\n", path);
+        Close();
+        return false;
+    }
+
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0 || header.version != CAPTURE_VERSION ||
+        header.headerSize != sizeof(CaptureHeader)) {
+        fprintf(stderr, "'%s' is not a version %d capture\n", path, CAPTURE_VERSION);
+        Close();
+        return false;
+    }
+    if (header.snapshotSize != sizeof(AnalysisSnapshot) || header.settingsSize != sizeof(AnalysisSettings)) {
+        fprintf(stderr, "'%s' was recorded by a build with different analysis structs\n", path);
+        Close();
+        return false;
+    }
+    // A closed capture's index is trusted once every entry points inside the records
+    if (header.indexOffset == 0 || !ReadIndex()) {
+        if (header.indexOffset != 0) fprintf(stderr, "'%s' has a damaged index; reading its records directly\n", path);
+        WalkRecords();
+    }
+    return true;
+}
+
+void CaptureFile::Close() {
+#ifdef _WIN32
+    if (base) UnmapViewOfFile(base);
+    if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (base) munmap((void*)base, size);
+    if (fd >= 0) close(fd);
+    fd = -1;
+#endif
+    base = nullptr;
+    size = 0;
+    index.clear();
+}
+
+// A record at `offset` that lies (with its payload) before `end` and whose size is the
+// one its type implies. Only records that pass get into the index, so readers can cast
+// payloads without checking sizes again.
+bool CaptureFile::IsValidRecord(uint64_t offset, uint64_t end) const {
+    if (offset < sizeof(CaptureHeader) || offset % CAPTURE_ALIGNMENT != 0) return false;
+    if (end > size || offset > end || end - offset < sizeof(CaptureRecord)) return false;
+    const CaptureRecord& record = *(const CaptureRecord*)(base + offset);
+    if (record.size > end - offset - sizeof(CaptureRecord)) return false;
+
+    switch (record.type) {
+        case CAPTURE_RECORD_AUDIO: {
+            if (record.size < sizeof(CaptureAudio)) return false;
+            const CaptureAudio& audio = *(const CaptureAudio*)(base + offset + sizeof(CaptureRecord));
+            if (audio.channels < 1 || audio.channels > MAX_AUDIO_CHANNELS) return false;
+            return record.size == sizeof(CaptureAudio) + sizeof(float) * (uint64_t)audio.frames * (uint64_t)audio.channels;
+        }
+        case CAPTURE_RECORD_SNAPSHOT: return record.size == header.snapshotSize;
+        case CAPTURE_RECORD_SETTINGS: return record.size == header.settingsSize;
+        default: return false;
+    }
+}
+
+bool CaptureFile::ReadIndex() {
+    if (header.indexOffset < sizeof(CaptureHeader) || header.indexOffset > size) return false;
+    if (header.recordCount > (size - header.indexOffset) / sizeof(CaptureIndexEntry)) return false;
+    const CaptureIndexEntry* entries = (const CaptureIndexEntry*)(base + header.indexOffset);
+    index.assign(entries, entries + header.recordCount);
+    for (const CaptureIndexEntry& entry : index) {
+        if (!IsValidRecord(entry.offset, header.indexOffset)) return false;
+        if (((const CaptureRecord*)(base + entry.offset))->type != entry.type) return false;
+    }
+    return true;
+}
+
+// Unfinished (or truncated) capture: walk the records and stop at the first torn one.
+void CaptureFile::WalkRecords() {
+    index.clear();
+    header.recordCount = 0;
+    header.blockCount = 0;
+    header.frameCount = 0;
+    uint64_t offset = sizeof(CaptureHeader);
+    while (IsValidRecord(offset, size)) {
+        const CaptureRecord& record = *(const CaptureRecord*)(base + offset);
+        CaptureIndexEntry entry = { offset, record.type, 0 };
+        index.push_back(entry);
+        if (record.type == CAPTURE_RECORD_AUDIO) {
+            header.blockCount++;
+            header.frameCount += ((const CaptureAudio*)(base + offset + sizeof(CaptureRecord)))->frames;
+        }
+        offset += sizeof(CaptureRecord) + PaddedSize(record.size);
+    }
+    header.recordCount = index.size();
+}
+
+bool ReadCaptureFormat(const char* path, int& sampleRate, int& blockFrames, int& channels) {
+    CaptureFile capture;
+    if (!capture.Open(path)) return false;
+    for (size_t i = 0; i < capture.GetRecordCount(); i++) {
+        if (capture.GetRecord(i).type != CAPTURE_RECORD_AUDIO) continue;
+        const CaptureAudio* audio = (const CaptureAudio*)capture.GetPayload(i);
+        sampleRate = audio->sampleRate;
+        blockFrames = audio->blockFrames;
+        channels = audio->channels;
+        return true;
+    }
+    fprintf(stderr, "Capture '%s' holds no audio\n", path);
+    return false;
+}
+
+// =========================================================
+// COMPARE
+// =========================================================
+
+#define CAPTURE_DEFAULT_TOLERANCE 1e-5f
+
+struct CaptureDiff {
+    const char* name;
+    float maxDiff = 0.0f;
+    size_t worstSnapshot = 0;
+};
+
+static void TrackDiff(CaptureDiff& diff, float a, float b, size_t snapshot) {
+    float d = fabsf(a - b);
+    if (d > diff.maxDiff) {
+        diff.maxDiff = d;
+        diff.worstSnapshot = snapshot;
+    }
+}
+
+int RunCaptureCompare(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: --compare-capture <reference> <candidate> [--tolerance f]\n");
+        return 1;
+    }
+    float tolerance = CAPTURE_DEFAULT_TOLERANCE;
+    for (int i = 3; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--tolerance") == 0) tolerance = (float)atof(argv[i + 1]);
+    }
+
+    CaptureFile reference, candidate;
+    if (!reference.Open(argv[1]) || !candidate.Open(argv[2])) return 1;
+
+    std::vector<const AnalysisSnapshot*> a, b;
+    for (size_t i = 0; i < reference.GetRecordCount(); i++) {
+        if (reference.GetRecord(i).type == CAPTURE_RECORD_SNAPSHOT) a.push_back((const AnalysisSnapshot*)reference.GetPayload(i));
+    }
+    for (size_t i = 0; i < candidate.GetRecordCount(); i++) {
+        if (candidate.GetRecord(i).type == CAPTURE_RECORD_SNAPSHOT) b.push_back((const AnalysisSnapshot*)candidate.GetPayload(i));
+    }
+
+    CaptureDiff diffs[] = { { "bass" }, { "glow" }, { "onset" }, { "bpm" }, { "bands" }, { "filterbank" }, { "channels" } };
+    size_t count = std::min(a.size(), b.size());
+    size_t beatMismatches = 0;
+    for (size_t s = 0; s < count; s++) {
+        const AnalysisSnapshot& x = *a[s];
+        const AnalysisSnapshot& y = *b[s];
+        TrackDiff(diffs[0], x.bass, y.bass, s);
+        TrackDiff(diffs[1], x.glow, y.glow, s);
+        TrackDiff(diffs[2], x.onset, y.onset, s);
+        TrackDiff(diffs[3], x.bpm, y.bpm, s);
+        for (int i = 0; i < NUM_BANDS; i++) TrackDiff(diffs[4], x.bands[i], y.bands[i], s);
+        // Counts come from the file: clamp them to the arrays they index
+        int bands = std::max(0, std::min(std::min(x.filterbankBands, y.filterbankBands), FILTERBANK_MAX_BANDS));
+        for (int i = 0; i < bands; i++) TrackDiff(diffs[5], x.filterbank[i], y.filterbank[i], s);
+        int channels = std::max(0, std::min(std::min(x.channels, y.channels), MAX_AUDIO_CHANNELS));
+        for (int c = 0; c < channels; c++) TrackDiff(diffs[6], x.channel[c].bass, y.channel[c].bass, s);
+        if (x.beatCount != y.beatCount) beatMismatches++;
+    }
+
+    printf("[compare] %zu / %zu snapshots, tolerance %g\n", a.size(), b.size(), tolerance);
+    printf("%-12s %14s %10s\n", "field", "max diff", "snapshot");
+    bool pass = a.size() == b.size() && beatMismatches == 0;
+    for (const CaptureDiff& diff : diffs) {
+        printf("%-12s %14.3g %10zu\n", diff.name, diff.maxDiff, diff.worstSnapshot);
+        if (diff.maxDiff > tolerance) pass = false;
+    }
+    printf("[compare] beat count mismatches: %zu\n", beatMismatches);
+    printf("[compare] %s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
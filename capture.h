@@ -0,0 +1,132 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "analysis.h"
+
+// =========================================================
+// CAPTURE FILES (record / replay)
+// =========================================================
+// A capture holds every block the analysis thread consumed (raw input planes plus
+// format), the snapshot it produced and every settings change it applied, in
+// analysis order. Replaying one through AUDIO_SOURCE_REPLAY feeds the same blocks
+// with the same boundaries and settings back into the live pipeline, so a glitch
+// from a show can be re-run, re-recorded and compared, or rendered for profiling.
+//
+// Layout (little-endian, every record 8-byte aligned so a mapped file is read in place):
+//
+//   CaptureHeader
+//   CaptureRecord + payload, padded to 8 bytes      (repeated)
+//   CaptureIndexEntry[recordCount]                  (at header.indexOffset)
+//
+// The index and the counts are written when the recording is stopped. A file left
+// behind by a crash has indexOffset 0 and, like a truncated one, is indexed by
+// walking its records up to the first incomplete one.
+// Snapshot and settings payloads are the in-memory structs, so a capture only
+// opens in a build with the same struct sizes (checked against the header).
+
+#define CAPTURE_MAGIC       "VBCAPT01"
+#define CAPTURE_VERSION     1
+#define CAPTURE_ALIGNMENT   8
+#define CAPTURE_WRITE_BUFFER (1 << 20)      // stdio buffer: one write() per ~1 MB of records
+
+enum CaptureRecordType {
+    CAPTURE_RECORD_AUDIO = 1,       // CaptureAudio + frames * channels floats, plane by plane
+    CAPTURE_RECORD_SNAPSHOT = 2,    // AnalysisSnapshot after the preceding audio record
+    CAPTURE_RECORD_SETTINGS = 3     // AnalysisSettings applied from the next audio record on
+};
+
+struct CaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t snapshotSize;          // sizeof(AnalysisSnapshot) of the recording build
+    uint32_t settingsSize;          // sizeof(AnalysisSettings) of the recording build
+    uint64_t recordCount;
+    uint64_t blockCount;            // Audio records
+    uint64_t frameCount;            // Audio frames over all audio records
+    uint64_t indexOffset;           // 0 until the recording is closed
+    int64_t createdUnix;
+};
+
+struct CaptureRecord {
+    uint32_t type;                  // CaptureRecordType
+    uint32_t size;                  // Payload bytes (without padding)
+    uint64_t sequence;              // AudioBlock::sequence the record belongs to
+    double time;                    // Seconds since the first block on the capture clock
+};
+
+struct CaptureAudio {
+    uint32_t frames;
+    int32_t channels;
+    int32_t sampleRate;
+    int32_t blockFrames;
+};
+
+struct CaptureIndexEntry {
+    uint64_t offset;                // File offset of the CaptureRecord
+    uint32_t type;
+    uint32_t reserved;
+};
+
+// --- RECORDING ---
+// One recording at a time. Start / stop from any thread; the analysis thread calls
+// CaptureAnalysedBlock for every block once it is analysed.
+
+bool StartCaptureRecording(const char* path);
+void StopCaptureRecording();
+bool IsCaptureRecording();
+uint64_t GetCaptureRecordedBlocks();
+
+// Analysis thread. Writes a settings record when `settingsGeneration` changed since
+// the last block, then the block and its snapshot.
+void CaptureAnalysedBlock(const AudioBlock& block, const AnalysisSnapshot& snapshot,
+                          const AnalysisSettings& settings, uint64_t settingsGeneration);
+
+// --- READING ---
+// Read-only memory mapping of a whole capture.
+
+class CaptureFile {
+public:
+    CaptureFile();
+    ~CaptureFile();
+
+    // False (after printing why) if the file is missing, foreign or from a build with other struct sizes.
+    bool Open(const char* path);
+    void Close();
+
+    // Every indexed record is aligned, lies inside the file and has the payload size
+    // its type implies (CaptureAudio plus its planes, or a whole snapshot / settings).
+    const CaptureHeader& GetHeader() const { return header; }
+    size_t GetRecordCount() const { return index.size(); }
+    const CaptureRecord& GetRecord(size_t i) const { return *(const CaptureRecord*)(base + index[i].offset); }
+    const void* GetPayload(size_t i) const { return base + index[i].offset + sizeof(CaptureRecord); }
+
+private:
+    bool IsValidRecord(uint64_t offset, uint64_t end) const;
+    bool ReadIndex();
+    void WalkRecords();
+
+    const uint8_t* base;
+    size_t size;
+    CaptureHeader header;
+    std::vector<CaptureIndexEntry> index;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
+
+// Format of the first audio record (for configuring a replay source).
+bool ReadCaptureFormat(const char* path, int& sampleRate, int& blockFrames, int& channels);
+
+// Run with `VisualBassSync --compare-capture <reference> <candidate> [--tolerance f]`.
+// Matches snapshots in order and prints the largest level differences and beat
+// mismatches. Returns 0 when every level is within tolerance and beats agree.
+int RunCaptureCompare(int argc, char** argv);
+
+#endif // CAPTURE_H
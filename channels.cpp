@@ -0,0 +1,77 @@
+#include "channels.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHANNELS_USE_SSE 1
+#endif
+
+void DeinterleaveBlock(const float* interleaved, unsigned long frames, int channels, AudioBlock& block) {
+    if (frames > FRAMES_PER_BUFFER) frames = FRAMES_PER_BUFFER;
+    int stride = channels < 1 ? 1 : channels;
+    int planes = stride > MAX_AUDIO_CHANNELS ? MAX_AUDIO_CHANNELS : stride;
+
+    block.frames = frames;
+    block.channels = planes;
+
+    unsigned long i = 0;
+    if (stride == 1) {
+        memcpy(block.samples, interleaved, sizeof(float) * frames);
+        i = frames;
+    }
+#if defined(CHANNELS_USE_SSE)
+    else if (stride == 2) {
+        // 4 frames per step: split L0 R0 L1 R1 | L2 R2 L3 R3 with two shuffles
+        float* left = block.planes[0];
+        float* right = block.planes[1];
+        const __m128 half = _mm_set1_ps(0.5f);
+        for (; i + 4 <= frames; i += 4) {
+            __m128 a = _mm_loadu_ps(interleaved + i * 2);
+            __m128 b = _mm_loadu_ps(interleaved + i * 2 + 4);
+            __m128 l = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 r = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_store_ps(left + i, l);
+            _mm_store_ps(right + i, r);
+            _mm_store_ps(block.samples + i, _mm_mul_ps(_mm_add_ps(l, r), half));
+        }
+    }
+#endif
+
+    // Generic path (and the SSE tail)
+    if (stride > 1) {
+        float invChannels = 1.0f / (float)stride;
+        for (; i < frames; i++) {
+            const float* frame = interleaved + i * stride;
+            float sum = 0.0f;
+            for (int c = 0; c < stride; c++) {
+                if (c < planes) block.planes[c][i] = frame[c];
+                sum += frame[c];
+            }
+            block.samples[i] = sum * invChannels;
+        }
+    }
+
+    for (unsigned long j = frames; j < FRAMES_PER_BUFFER; j++) {
+        block.samples[j] = 0.0f;
+    }
+    if (planes > 1) {
+        for (int c = 0; c < planes; c++) {
+            for (unsigned long j = frames; j < FRAMES_PER_BUFFER; j++) block.planes[c][j] = 0.0f;
+        }
+    }
+}
+
+void ComputeSidePlane(const AudioBlock& block, float* side) {
+    const float* left = block.planes[0];
+    const float* right = block.planes[1];
+    int i = 0;
+#if defined(CHANNELS_USE_SSE)
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (; i + 4 <= FRAMES_PER_BUFFER; i += 4) {
+        _mm_store_ps(side + i, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(left + i), _mm_load_ps(right + i)), half));
+    }
+#endif
+    for (; i < FRAMES_PER_BUFFER; i++) {
+        side[i] = (left[i] - right[i]) * 0.5f;
+    }
+}
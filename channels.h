@@ -0,0 +1,23 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include "audioring.h"
+
+// =========================================================
+// MULTI-CHANNEL BLOCKS
+// =========================================================
+// Capture delivers `channels` interleaved samples per frame. They are split into
+// AUDIO_PLANE_ALIGNMENT aligned planes in the block, plus a mono mix in `samples`
+// (the mean of all channels, i.e. the mid signal for stereo). Both kernels are
+// one pass over the input, so the cost is linear in channels.
+
+// Fill block.samples / block.planes / block.channels / block.frames from interleaved
+// input, zero-padding to FRAMES_PER_BUFFER. `channels` is clamped to MAX_AUDIO_CHANNELS
+// (extra input channels are skipped). Mono input only fills `samples`.
+void DeinterleaveBlock(const float* interleaved, unsigned long frames, int channels, AudioBlock& block);
+
+// (planes[0] - planes[1]) / 2 for FRAMES_PER_BUFFER samples. `side` must be
+// AUDIO_PLANE_ALIGNMENT aligned. Requires block.channels >= 2.
+void ComputeSidePlane(const AudioBlock& block, float* side);
+
+#endif // CHANNELS_H
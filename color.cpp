@@ -0,0 +1,112 @@
+#include "color.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define COLOR_USE_SSE 1
+#endif
+
+// Pure hue wheel: each channel in 0..1 at s = v = 1, one array per channel for vector gathers.
+struct HueTable {
+    float r[HUE_LUT_SIZE];
+    float g[HUE_LUT_SIZE];
+    float b[HUE_LUT_SIZE];
+
+    HueTable() {
+        for (int i = 0; i < HUE_LUT_SIZE; i++) {
+            float h = (float)i / (float)HUE_LUT_SIZE * 6.0f;
+            int sector = (int)h;
+            float f = h - (float)sector;
+            float rise = f, fall = 1.0f - f;
+            switch (sector) {
+                case 0:  r[i] = 1.0f; g[i] = rise; b[i] = 0.0f; break;
+                case 1:  r[i] = fall; g[i] = 1.0f; b[i] = 0.0f; break;
+                case 2:  r[i] = 0.0f; g[i] = 1.0f; b[i] = rise; break;
+                case 3:  r[i] = 0.0f; g[i] = fall; b[i] = 1.0f; break;
+                case 4:  r[i] = rise; g[i] = 0.0f; b[i] = 1.0f; break;
+                default: r[i] = 1.0f; g[i] = 0.0f; b[i] = fall; break;
+            }
+        }
+    }
+};
+
+static const HueTable hueTable;
+
+static inline float Clamp01(float x) {
+    return x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+static inline int HueIndex(float h) {
+    float turn = h - floorf(h);
+    return (int)(turn * (float)HUE_LUT_SIZE + 0.5f) & (HUE_LUT_SIZE - 1);
+}
+
+// channel = v * (1 - s + s * pure): pure 1 gives v, pure 0 gives v * (1 - s)
+Color HSVToColor(float h, float s, float v) {
+    int i = HueIndex(h);
+    s = Clamp01(s);
+    float scale = Clamp01(v) * 255.0f;
+    float base = 1.0f - s;
+    return (Color){
+        (unsigned char)((base + s * hueTable.r[i]) * scale + 0.5f),
+        (unsigned char)((base + s * hueTable.g[i]) * scale + 0.5f),
+        (unsigned char)((base + s * hueTable.b[i]) * scale + 0.5f),
+        255
+    };
+}
+
+Color HueToColor(float hueDegrees) {
+    int i = HueIndex(hueDegrees / 360.0f);
+    return (Color){
+        (unsigned char)(hueTable.r[i] * 255.0f + 0.5f),
+        (unsigned char)(hueTable.g[i] * 255.0f + 0.5f),
+        (unsigned char)(hueTable.b[i] * 255.0f + 0.5f),
+        255
+    };
+}
+
+void HSVToColorBatch(const float* h, const float* s, const float* v, Color* out, int count) {
+    int n = 0;
+
+#if defined(COLOR_USE_SSE)
+    static_assert(sizeof(Color) == 4, "Color must pack into 32 bits");
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 lutScale = _mm_set1_ps((float)HUE_LUT_SIZE);
+    const __m128 byteScale = _mm_set1_ps(255.0f);
+    const __m128i lutMask = _mm_set1_epi32(HUE_LUT_SIZE - 1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+    alignas(16) int index[4];
+
+    for (; n + 4 <= count; n += 4) {
+        // Wrap the hue with floor (SSE2 has no round-down, so correct the truncation of negatives)
+        __m128 hue = _mm_loadu_ps(h + n);
+        __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(hue));
+        __m128 floored = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, hue), one));
+        __m128 turn = _mm_sub_ps(hue, floored);
+        __m128i lut = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(turn, lutScale)), lutMask);
+        _mm_store_si128((__m128i*)index, lut);
+
+        __m128 pr = _mm_set_ps(hueTable.r[index[3]], hueTable.r[index[2]], hueTable.r[index[1]], hueTable.r[index[0]]);
+        __m128 pg = _mm_set_ps(hueTable.g[index[3]], hueTable.g[index[2]], hueTable.g[index[1]], hueTable.g[index[0]]);
+        __m128 pb = _mm_set_ps(hueTable.b[index[3]], hueTable.b[index[2]], hueTable.b[index[1]], hueTable.b[index[0]]);
+
+        __m128 sat = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(s + n), zero), one);
+        __m128 scale = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(v + n), zero), one), byteScale);
+        __m128 base = _mm_sub_ps(one, sat);
+
+        __m128i r = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(base, _mm_mul_ps(sat, pr)), scale));
+        __m128i g = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(base, _mm_mul_ps(sat, pg)), scale));
+        __m128i b = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(base, _mm_mul_ps(sat, pb)), scale));
+
+        // Color is { r, g, b, a } in memory: one little-endian 32-bit word per colour
+        __m128i packed = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)), _mm_or_si128(_mm_slli_epi32(b, 16), alpha));
+        _mm_storeu_si128((__m128i*)(out + n), packed);
+    }
+#endif
+
+    for (; n < count; n++) {
+        out[n] = HSVToColor(h[n], s[n], v[n]);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef COLOR_H
+#define COLOR_H
+
+#include "raylib.h"
+
+// =========================================================
+// HSV -> RGB
+// =========================================================
+// One shared converter for every visualizer and menu. A fully saturated hue
+// wheel is tabulated once at HUE_LUT_SIZE steps; any saturation / value is then
+// a linear blend of that entry towards white and a scale, so a conversion is
+// one table read and a few multiply-adds with no branches. The batch form runs
+// four colours per step with SSE2 when available.
+
+#define HUE_LUT_SIZE 4096       // Power of two; 0.09 degree steps
+
+// h wraps (0..1 is one turn), s and v are clamped to 0..1.
+Color HSVToColor(float h, float s, float v);
+
+// Fully saturated, full value colour of a hue in degrees (wraps), like ColorFromHSV(h, 1, 1).
+Color HueToColor(float hueDegrees);
+
+// out[i] = HSVToColor(h[i], s[i], v[i]) for `count` colours.
+void HSVToColorBatch(const float* h, const float* s, const float* v, Color* out, int count);
+
+#endif // COLOR_H
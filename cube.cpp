@@ -1,4 +1,5 @@
 #include "cube.h"
+#include "color.h"
 #include "raymath.h"
 #include "rlgl.h"
 #include <cmath>
@@ -34,7 +35,7 @@ void Cube::Update(float totalTime, float glow, float hue, const CubeSettings& se
 
     currentPosition = Vector3RotateByAxisAngle(localPos, Vector3{ 0.0f, 1.0f, 0.0f }, swivelAngleRad);
 
-    color = ColorFromHSV(hue * 360.0f, 0.8f, 0.9f);
+    color = HSVToColor(hue, 0.8f, 0.9f);
     currentSize = baseSize;
 }
 
@@ -0,0 +1,97 @@
+#include "decimator.h"
+#include "fft.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static const double TWO_PI = 6.283185307179586;
+
+Decimator::Decimator()
+    : factor(0), coeffs(nullptr), delay(nullptr), groupPos(0), writePos(0)
+{
+}
+
+Decimator::~Decimator() {
+    FreeAligned(coeffs);
+    FreeAligned(delay);
+}
+
+bool Decimator::Configure(int newFactor) {
+    if (newFactor < DECIMATE_MIN_FACTOR || newFactor > DECIMATE_MAX_FACTOR) return false;
+    if (newFactor == factor && coeffs) {
+        Reset();
+        return true;
+    }
+
+    int taps = newFactor * DECIMATE_TAPS_PER_PHASE;
+    float* newCoeffs = AllocAlignedFloats(taps);
+    float* newDelay = AllocAlignedFloats(newFactor * 2 * DECIMATE_TAPS_PER_PHASE);
+    if (!newCoeffs || !newDelay) {
+        FreeAligned(newCoeffs);
+        FreeAligned(newDelay);
+        return false;
+    }
+    FreeAligned(coeffs);
+    FreeAligned(delay);
+    coeffs = newCoeffs;
+    delay = newDelay;
+    factor = newFactor;
+
+    // Blackman-windowed sinc, cutoff in cycles per input sample
+    std::vector<double> h(taps);
+    double cutoff = DECIMATE_CUTOFF / (double)factor;
+    double center = (taps - 1) * 0.5;
+    double sum = 0.0;
+    for (int k = 0; k < taps; k++) {
+        double x = k - center;
+        double sinc = (x == 0.0) ? 2.0 * cutoff : sin(TWO_PI * cutoff * x) / (0.5 * TWO_PI * x);
+        double w = 0.42 - 0.5 * cos(TWO_PI * k / (taps - 1)) + 0.08 * cos(2.0 * TWO_PI * k / (taps - 1));
+        h[k] = sinc * w;
+        sum += h[k];
+    }
+
+    // Sub-filter q holds h[q], h[q + factor], ... reversed, so that its dot product with the
+    // delay line of phase (factor - 1 - q), oldest sample first, is that phase's contribution.
+    for (int q = 0; q < factor; q++) {
+        for (int j = 0; j < DECIMATE_TAPS_PER_PHASE; j++) {
+            coeffs[q * DECIMATE_TAPS_PER_PHASE + j] = (float)(h[(DECIMATE_TAPS_PER_PHASE - 1 - j) * factor + q] / sum);
+        }
+    }
+
+    Reset();
+    return true;
+}
+
+void Decimator::Reset() {
+    if (delay) memset(delay, 0, sizeof(float) * factor * 2 * DECIMATE_TAPS_PER_PHASE);
+    groupPos = 0;
+    writePos = 0;
+}
+
+int Decimator::Process(const float* samples, int count, float* out) {
+    if (!coeffs) return 0;
+
+    const int lineLength = 2 * DECIMATE_TAPS_PER_PHASE;
+    int written = 0;
+    for (int i = 0; i < count; i++) {
+        // Each slot is written twice so the newest DECIMATE_TAPS_PER_PHASE values are always contiguous
+        float* line = delay + groupPos * lineLength;
+        line[writePos] = samples[i];
+        line[writePos + DECIMATE_TAPS_PER_PHASE] = samples[i];
+
+        if (++groupPos < factor) continue;
+
+        // Group complete: one output from every sub-filter
+        int window = writePos + 1;
+        float sum = 0.0f;
+        for (int q = 0; q < factor; q++) {
+            const float* phaseLine = delay + (factor - 1 - q) * lineLength;
+            sum += DotProduct(phaseLine + window, coeffs + q * DECIMATE_TAPS_PER_PHASE, DECIMATE_TAPS_PER_PHASE);
+        }
+        out[written++] = sum;
+
+        groupPos = 0;
+        writePos = (writePos + 1) % DECIMATE_TAPS_PER_PHASE;
+    }
+    return written;
+}
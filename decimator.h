@@ -0,0 +1,47 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+// =========================================================
+// POLYPHASE DECIMATOR
+// =========================================================
+// Low-pass FIR + downsample by `factor` in one step. The FIR is split into
+// `factor` sub-filters of DECIMATE_TAPS_PER_PHASE taps; each input sample lands
+// in its phase's delay line and one output is produced per `factor` inputs, so
+// only DECIMATE_TAPS_PER_PHASE multiply-adds are spent per input sample and none
+// on outputs that would be thrown away. Delay lines are stored twice over so
+// every sub-filter is one contiguous SIMD dot product (see DotProduct in fft.h).
+
+#define DECIMATE_MIN_FACTOR      8
+#define DECIMATE_MAX_FACTOR      16
+#define DECIMATE_DEFAULT_FACTOR  8
+#define DECIMATE_TAPS_PER_PHASE  16         // factor * 16 taps total
+#define DECIMATE_CUTOFF          0.25f      // -6 dB point in cycles per output sample (half the output Nyquist)
+#define DECIMATE_FFT_SIZE        256        // Post-decimation FFT: 21.5 Hz bins at 44.1 kHz / 8
+
+class Decimator {
+public:
+    Decimator();
+    ~Decimator();
+
+    // Windowed-sinc low-pass with unity DC gain. Returns false for factors outside
+    // DECIMATE_MIN_FACTOR..DECIMATE_MAX_FACTOR.
+    bool Configure(int factor);
+    void Reset();
+
+    // Consume `count` input samples and write the decimated ones to `out`
+    // (at most count / factor + 1). Returns the number written. Partial groups
+    // carry over to the next call, so block size never changes the output.
+    int Process(const float* samples, int count, float* out);
+
+    int GetFactor() const { return factor; }
+    int GetTaps() const { return factor * DECIMATE_TAPS_PER_PHASE; }
+
+private:
+    int factor;
+    float* coeffs;      // factor sub-filters of DECIMATE_TAPS_PER_PHASE, oldest tap first
+    float* delay;       // factor delay lines of 2 * DECIMATE_TAPS_PER_PHASE
+    int groupPos;       // Phase the next input sample belongs to
+    int writePos;       // Slot of the current group in every delay line
+};
+
+#endif // DECIMATOR_H
@@ -0,0 +1,249 @@
+#include "fft.h"
+#include <map>
+#include <mutex>
+#include <new>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FFT_USE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FFT_USE_SSE 1
+#endif
+
+// --- ALIGNED BUFFERS ---
+
+float* AllocAlignedFloats(int count) {
+    if (count <= 0) return nullptr;
+    return static_cast<float*>(::operator new(sizeof(float) * (size_t)count, std::align_val_t(FFT_ALIGNMENT), std::nothrow));
+}
+
+void FreeAligned(void* ptr) {
+    if (ptr) ::operator delete(ptr, std::align_val_t(FFT_ALIGNMENT));
+}
+
+// --- PLAN CACHE ---
+
+static std::map<int, kiss_fftr_cfg> planCache;
+static std::mutex planMutex;
+
+kiss_fftr_cfg GetFFTPlan(int fftSize) {
+    // kiss_fftr only supports even sizes
+    if (fftSize <= 0 || (fftSize & 1)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(planMutex);
+    auto it = planCache.find(fftSize);
+    if (it != planCache.end()) return it->second;
+
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(fftSize, 0, NULL, NULL);
+    if (cfg) planCache[fftSize] = cfg;
+    return cfg;
+}
+
+void ClearFFTPlans() {
+    std::lock_guard<std::mutex> lock(planMutex);
+    for (auto& entry : planCache) {
+        kiss_fftr_free(entry.second);
+    }
+    planCache.clear();
+}
+
+// --- SPECTRUM ---
+
+bool AllocSpectrum(FFTSpectrum& spectrum, int fftSize) {
+    if (spectrum.fftSize == fftSize && spectrum.plan) return true;
+    FreeSpectrum(spectrum);
+
+    kiss_fftr_cfg plan = GetFFTPlan(fftSize);
+    if (!plan) return false;
+
+    int bins = fftSize / 2 + 1;
+    spectrum.input     = AllocAlignedFloats(fftSize);
+    spectrum.freq      = reinterpret_cast<kiss_fft_cpx*>(AllocAlignedFloats(bins * 2));
+    spectrum.magnitude = AllocAlignedFloats(bins);
+    if (!spectrum.input || !spectrum.freq || !spectrum.magnitude) {
+        FreeSpectrum(spectrum);
+        return false;
+    }
+
+    memset(spectrum.input, 0, sizeof(float) * fftSize);
+    memset(spectrum.freq, 0, sizeof(kiss_fft_cpx) * bins);
+    memset(spectrum.magnitude, 0, sizeof(float) * bins);
+    spectrum.fftSize = fftSize;
+    spectrum.bins = bins;
+    spectrum.plan = plan;
+    return true;
+}
+
+void FreeSpectrum(FFTSpectrum& spectrum) {
+    FreeAligned(spectrum.input);
+    FreeAligned(spectrum.freq);
+    FreeAligned(spectrum.magnitude);
+    spectrum = FFTSpectrum();
+}
+
+void ComputeSpectrum(FFTSpectrum& spectrum, const float* samples, int count) {
+    if (!spectrum.plan) return;
+
+    int n = spectrum.fftSize;
+    if (count >= n) {
+        memcpy(spectrum.input, samples + (count - n), sizeof(float) * n);
+    } else {
+        memcpy(spectrum.input, samples, sizeof(float) * count);
+        memset(spectrum.input + count, 0, sizeof(float) * (n - count));
+    }
+
+    TransformSpectrum(spectrum);
+}
+
+void TransformSpectrum(FFTSpectrum& spectrum) {
+    if (!spectrum.plan) return;
+
+    kiss_fftr(spectrum.plan, spectrum.input, spectrum.freq);
+    ComputeMagnitudes(spectrum.freq, spectrum.magnitude, spectrum.bins);
+}
+
+// --- SIMD KERNELS ---
+
+void ComputeMagnitudes(const kiss_fft_cpx* freq, float* magnitude, int bins) {
+    const float* in = reinterpret_cast<const float*>(freq);
+    int i = 0;
+
+#if defined(FFT_USE_AVX)
+    // 8 complex values per step; regroup 128-bit lanes so the shuffle yields bins in order
+    for (; i + 8 <= bins; i += 8) {
+        __m256 lo = _mm256_loadu_ps(in + 2 * i);        // c0 c1 | c2 c3
+        __m256 hi = _mm256_loadu_ps(in + 2 * i + 8);    // c4 c5 | c6 c7
+        __m256 a  = _mm256_permute2f128_ps(lo, hi, 0x20);  // c0 c1 | c4 c5
+        __m256 b  = _mm256_permute2f128_ps(lo, hi, 0x31);  // c2 c3 | c6 c7
+        __m256 re = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 im = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 power = _mm256_add_ps(_mm256_mul_ps(re, re), _mm256_mul_ps(im, im));
+        _mm256_storeu_ps(magnitude + i, _mm256_sqrt_ps(power));
+    }
+#elif defined(FFT_USE_SSE)
+    // 4 complex values per step
+    for (; i + 4 <= bins; i += 4) {
+        __m128 a  = _mm_loadu_ps(in + 2 * i);       // c0 c1
+        __m128 b  = _mm_loadu_ps(in + 2 * i + 4);   // c2 c3
+        __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        _mm_storeu_ps(magnitude + i, _mm_sqrt_ps(power));
+    }
+#endif
+
+    for (; i < bins; i++) {
+        magnitude[i] = sqrtf(freq[i].r * freq[i].r + freq[i].i * freq[i].i);
+    }
+}
+
+float SumRange(const float* values, int first, int last) {
+    int i = first;
+    float sum = 0.0f;
+
+#if defined(FFT_USE_AVX)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= last; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_loadu_ps(values + i));
+    }
+    __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    acc4 = _mm_add_ps(acc4, _mm_movehl_ps(acc4, acc4));
+    acc4 = _mm_add_ss(acc4, _mm_shuffle_ps(acc4, acc4, 1));
+    sum = _mm_cvtss_f32(acc4);
+#elif defined(FFT_USE_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= last; i += 4) {
+        acc = _mm_add_ps(acc, _mm_loadu_ps(values + i));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#endif
+
+    for (; i < last; i++) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+float DotProduct(const float* values, const float* weights, int count) {
+    int i = 0;
+    float sum = 0.0f;
+
+#if defined(FFT_USE_AVX)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(values + i), _mm256_loadu_ps(weights + i)));
+    }
+    __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    acc4 = _mm_add_ps(acc4, _mm_movehl_ps(acc4, acc4));
+    acc4 = _mm_add_ss(acc4, _mm_shuffle_ps(acc4, acc4, 1));
+    sum = _mm_cvtss_f32(acc4);
+#elif defined(FFT_USE_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(weights + i)));
+    }
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    sum = _mm_cvtss_f32(acc);
+#endif
+
+    for (; i < count; i++) {
+        sum += values[i] * weights[i];
+    }
+    return sum;
+}
+
+float ComputeBassMagnitude(const FFTSpectrum& spectrum, float sampleRate) {
+    if (!spectrum.plan) return 0.0f;
+
+    float freqRes = sampleRate / (float)spectrum.fftSize;
+    int   lowBin  = (int)(BASS_LOW_FREQ / freqRes);
+    int   highBin = (int)(BASS_HIGH_FREQ / freqRes);
+    if (highBin >= spectrum.bins) highBin = spectrum.bins - 1;
+    int   count   = highBin - lowBin + 1;
+    float sumBass = (count > 0) ? SumRange(spectrum.magnitude, lowBin, highBin + 1) : 0.0f;
+
+    return (count > 0) ? (sumBass / (float)count) : 0.0f;
+}
+
+float BoostBassLevel(float magnitude, float normFactor, float boostExponent) {
+    float normalized = (normFactor > 0.0f) ? magnitude / normFactor : 0.0f;
+    if (normalized > 1.0f) normalized = 1.0f;
+    if (normalized < 0.0f) normalized = 0.0f;
+
+    return powf(normalized, boostExponent);
+}
+
+float ComputeBassLevel(const FFTSpectrum& spectrum, float sampleRate) {
+    return BoostBassLevel(ComputeBassMagnitude(spectrum, sampleRate), BASS_NORM_FACTOR, BASS_BOOST_EXPONENT);
+}
+
+// --- DEFAULT ENGINE ---
+
+static FFTSpectrum defaultSpectrum;
+
+void InitFFT(int fftSize) {
+    AllocSpectrum(defaultSpectrum, fftSize);
+}
+
+void CloseFFT() {
+    FreeSpectrum(defaultSpectrum);
+    ClearFFTPlans();
+}
+
+float ProcessFFT(const float* audioBuffer, int bufferSize) {
+    if (!defaultSpectrum.plan) InitFFT(FFT_SIZE);
+    if (!defaultSpectrum.plan) return 0.0f;
+
+    ComputeSpectrum(defaultSpectrum, audioBuffer, bufferSize);
+    return ComputeBassLevel(defaultSpectrum, (float)DEFAULT_SAMPLE_RATE);
+}
+
+const FFTSpectrum& GetFFTSpectrum() {
+    return defaultSpectrum;
+}
@@ -1,9 +1,74 @@
 #ifndef FFT_H
 #define FFT_H
 
-// Declare InitFFT with parameters
-void InitFFT(const float* audioBuffer, int bufferSize);
+#include "kiss_fftr.h"
+#include "globals.h"
+
+// Reference FFT size the level constants below were tuned at. Other sizes scale
+// their magnitudes to match (see stft.h, slidingdft.h and the block FFT mode).
+#define FFT_SIZE            FRAMES_PER_BUFFER
+
+#define BASS_LOW_FREQ       35.0f
+#define BASS_HIGH_FREQ      75.0f
+#define BASS_NORM_FACTOR    275.0f
+#define BASS_BOOST_EXPONENT 2.0f
+
+// Alignment for spectrum buffers (wide enough for AVX loads)
+#define FFT_ALIGNMENT 32
+
+// --- ALIGNED BUFFERS ---
+float* AllocAlignedFloats(int count);
+void FreeAligned(void* ptr);
+
+// --- PLAN CACHE ---
+// Real-input plans are built once per size and shared by every spectrum of that size.
+// Returns nullptr for odd or non-positive sizes.
+kiss_fftr_cfg GetFFTPlan(int fftSize);
+void ClearFFTPlans();
+
+// --- SPECTRUM ---
+// Preallocated working set for one real FFT. All buffers are FFT_ALIGNMENT aligned.
+struct FFTSpectrum {
+    int fftSize = 0;               // Time-domain samples
+    int bins = 0;                  // fftSize / 2 + 1
+    kiss_fftr_cfg plan = nullptr;  // Owned by the plan cache
+    float* input = nullptr;        // fftSize real samples
+    kiss_fft_cpx* freq = nullptr;  // bins complex values
+    float* magnitude = nullptr;    // bins magnitudes
+};
+
+bool AllocSpectrum(FFTSpectrum& spectrum, int fftSize);
+void FreeSpectrum(FFTSpectrum& spectrum);
+
+// Copy (and zero-pad) `count` samples into the spectrum, transform and fill `magnitude`.
+// If `count` exceeds the FFT size only the newest fftSize samples are used.
+void ComputeSpectrum(FFTSpectrum& spectrum, const float* samples, int count);
+
+// Transform whatever is already in `spectrum.input` and fill `magnitude`.
+void TransformSpectrum(FFTSpectrum& spectrum);
+
+// |freq[i]| for `bins` values. SSE/AVX when available, scalar otherwise.
+void ComputeMagnitudes(const kiss_fft_cpx* freq, float* magnitude, int bins);
+
+// Sum of values[first..last). SSE/AVX when available, scalar otherwise.
+float SumRange(const float* values, int first, int last);
+
+// Sum of values[i] * weights[i] for `count` values. SSE/AVX when available, scalar otherwise.
+float DotProduct(const float* values, const float* weights, int count);
+
+// Mean magnitude of the BASS_LOW_FREQ..BASS_HIGH_FREQ bins.
+float ComputeBassMagnitude(const FFTSpectrum& spectrum, float sampleRate);
+
+// magnitude / normFactor, clamped to 0..1 and raised to boostExponent.
+float BoostBassLevel(float magnitude, float normFactor, float boostExponent);
+
+// Bass magnitude boosted with the default BASS_NORM_FACTOR / BASS_BOOST_EXPONENT.
+float ComputeBassLevel(const FFTSpectrum& spectrum, float sampleRate);
+
+// --- DEFAULT ENGINE ---
+void InitFFT(int fftSize);
 void CloseFFT();
 float ProcessFFT(const float* audioBuffer, int bufferSize);
+const FFTSpectrum& GetFFTSpectrum();
 
 #endif // FFT_H
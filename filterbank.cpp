@@ -0,0 +1,102 @@
+#include "filterbank.h"
+#include <cmath>
+
+const char* GetFilterbankScaleName(int scale) {
+    switch (scale) {
+        case FILTERBANK_OFF: return "Off";
+        case FILTERBANK_MEL: return "Mel";
+        case FILTERBANK_CQT: return "Constant-Q";
+        default:             return "?";
+    }
+}
+
+static float HzToMel(float hz) { return 2595.0f * log10f(1.0f + hz / 700.0f); }
+static float MelToHz(float mel) { return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f); }
+
+// Frequency of point `i` of `count` evenly spaced points on the bank's warped scale.
+static float WarpedPoint(int scale, float minFreq, float maxFreq, int i, int count) {
+    float t = (float)i / (float)(count - 1);
+    if (scale == FILTERBANK_MEL) {
+        float lo = HzToMel(minFreq);
+        return MelToHz(lo + (HzToMel(maxFreq) - lo) * t);
+    }
+    return minFreq * powf(maxFreq / minFreq, t);
+}
+
+bool BuildFilterbank(Filterbank& bank, int scale, int bands, int fftSize, float sampleRate) {
+    bank.scale = scale;
+    bank.bands = 0;
+    bank.fftSize = fftSize;
+    bank.sampleRate = sampleRate;
+    bank.weights.clear();
+    if (scale != FILTERBANK_MEL && scale != FILTERBANK_CQT) return false;
+    if (fftSize < 2 || sampleRate <= 0.0f) return false;
+
+    if (bands < FILTERBANK_MIN_BANDS) bands = FILTERBANK_MIN_BANDS;
+    if (bands > FILTERBANK_MAX_BANDS) bands = FILTERBANK_MAX_BANDS;
+
+    int bins = fftSize / 2 + 1;
+    float freqRes = sampleRate / (float)fftSize;
+    float maxFreq = fminf(FILTERBANK_MAX_FREQ, sampleRate * 0.5f);
+    if (maxFreq <= FILTERBANK_MIN_FREQ) return false;
+
+    // bands + 2 edge points: band k rises from point k, peaks at k + 1 and falls to k + 2
+    float points[FILTERBANK_MAX_BANDS + 2];
+    for (int i = 0; i < bands + 2; i++) {
+        points[i] = WarpedPoint(scale, FILTERBANK_MIN_FREQ, maxFreq, i, bands + 2);
+    }
+
+    for (int k = 0; k < bands; k++) {
+        float low = points[k], center = points[k + 1], high = points[k + 2];
+        int offset = (int)bank.weights.size();
+        int first = (int)ceilf(low / freqRes);
+        int last = (int)floorf(high / freqRes);
+        if (last > bins - 1) last = bins - 1;
+
+        // Nonzero part of the triangle, trimmed at both ends
+        float sum = 0.0f;
+        int start = -1;
+        for (int b = first; b <= last; b++) {
+            float f = b * freqRes;
+            float w = (f < center) ? (f - low) / (center - low) : (high - f) / (high - center);
+            if (w <= 0.0f) {
+                if (start >= 0) break;
+                continue;
+            }
+            if (start < 0) start = b;
+            bank.weights.push_back(w);
+            sum += w;
+        }
+
+        // Narrower than a bin: linear interpolation at the centre frequency
+        if (start < 0) {
+            float position = fminf(center / freqRes, (float)(bins - 1));
+            start = (int)position;
+            float frac = position - (float)start;
+            bank.weights.push_back(1.0f - frac);
+            sum = 1.0f - frac;
+            if (start + 1 < bins && frac > 0.0f) {
+                bank.weights.push_back(frac);
+                sum += frac;
+            }
+        }
+
+        int count = (int)bank.weights.size() - offset;
+        for (int i = 0; i < count; i++) bank.weights[offset + i] /= sum;
+
+        bank.centerFreq[k] = center;
+        bank.firstBin[k] = start;
+        bank.binCount[k] = count;
+        bank.weightOffset[k] = offset;
+    }
+
+    bank.bands = bands;
+    return true;
+}
+
+void ApplyFilterbank(const Filterbank& bank, const float* magnitude, float* magnitudesOut) {
+    const float* weights = bank.weights.data();
+    for (int k = 0; k < bank.bands; k++) {
+        magnitudesOut[k] = DotProduct(magnitude + bank.firstBin[k], weights + bank.weightOffset[k], bank.binCount[k]);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef FILTERBANK_H
+#define FILTERBANK_H
+
+#include <vector>
+#include "fft.h"
+
+// =========================================================
+// MEL / CONSTANT-Q FILTERBANK
+// =========================================================
+// Perceptual (mel) or log-spaced (constant-Q) bands on top of the linear FFT
+// spectrum. Each band is a triangular filter stored as a short run of nonzero
+// weights, built once per FFT size and sample rate. A block then costs one SIMD
+// dot product per band over only the bins that band touches, a small fraction
+// of the FFT that produced the spectrum.
+
+#define FILTERBANK_MIN_BANDS     24
+#define FILTERBANK_MAX_BANDS     96
+#define FILTERBANK_DEFAULT_BANDS 48
+#define FILTERBANK_MIN_FREQ      30.0f
+#define FILTERBANK_MAX_FREQ      16000.0f     // Lowered to Nyquist for low sample rates
+
+enum FilterbankScale {
+    FILTERBANK_OFF,
+    FILTERBANK_MEL,     // Evenly spaced on the mel scale
+    FILTERBANK_CQT,     // Evenly spaced in log frequency (constant Q, bands / octaves per octave)
+    FILTERBANK_SCALE_COUNT
+};
+
+const char* GetFilterbankScaleName(int scale);
+
+struct Filterbank {
+    int scale = FILTERBANK_OFF;
+    int bands = 0;                  // 0 when off or not built
+    int fftSize = 0;
+    float sampleRate = 0.0f;
+    float centerFreq[FILTERBANK_MAX_BANDS] = {};
+    int firstBin[FILTERBANK_MAX_BANDS] = {};
+    int binCount[FILTERBANK_MAX_BANDS] = {};
+    int weightOffset[FILTERBANK_MAX_BANDS] = {};
+    std::vector<float> weights;     // Every band's nonzero weights back to back
+};
+
+// Triangles between neighbouring centre frequencies, normalised to unit sum so each
+// band is a weighted mean magnitude (comparable to bands.h). A triangle narrower than
+// one bin interpolates the two bins around its centre instead. `bands` is clamped to
+// FILTERBANK_MIN_BANDS..FILTERBANK_MAX_BANDS. Returns false (bands = 0) when off.
+bool BuildFilterbank(Filterbank& bank, int scale, int bands, int fftSize, float sampleRate);
+
+// Raw weighted mean magnitude per band (bank.bands values).
+void ApplyFilterbank(const Filterbank& bank, const float* magnitude, float* magnitudesOut);
+
+#endif // FILTERBANK_H
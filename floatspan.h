@@ -0,0 +1,17 @@
+#ifndef FLOATSPAN_H
+#define FLOATSPAN_H
+
+#include <cstddef>
+
+// Non-owning view of a float array.
+struct FloatSpan {
+    const float* data = nullptr;
+    size_t size = 0;
+
+    const float* begin() const { return data; }
+    const float* end() const { return data + size; }
+    float operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+#endif // FLOATSPAN_H
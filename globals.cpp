@@ -1,4 +1,5 @@
 #include "globals.h"
+#include "audioring.h"
 #include "Particle01.h"
 #include <iostream>
 #include <string>
@@ -29,8 +30,7 @@ namespace fs = std::filesystem;
 // =========================================================
 
 // Audio & Visual Globals
-volatile int audioDataReady = 0;
-float gAudioBuffer[FRAMES_PER_BUFFER];
+AudioRing gAudioRing;
 float glow_value = 0.0f;
 bool escape_mode = false;
 float hueShift = 0.0f;
@@ -4,11 +4,13 @@
 #include "raylib.h"
 #include "cube.h"
 
+// Capacity of one audio block and the default device buffer. Runtime block sizes
+// (see AudioSourceConfig) may be smaller and use a prefix of each block.
 #define FRAMES_PER_BUFFER 512
-#define DEFAULT_MAX_PARTICLES 1250
 
-extern float gAudioBuffer[FRAMES_PER_BUFFER];
-extern volatile int audioDataReady;
+// Default capture rate. The real rate travels with each AudioBlock.
+#define DEFAULT_SAMPLE_RATE 44100
+#define DEFAULT_MAX_PARTICLES 1250
 
 extern float glow_value;
 extern float hueShift;
@@ -1,8 +1,25 @@
 #include "gravityorbs.h"
 #include "raylib.h"  // For Vector2, Color, and drawing functions
-#include "raymath.h" // For Vector2 math functions
+#include "rlgl.h"    // For the batched quad path
+#include "globals.h"
+#include "orbgrid.h"
 #include <stdlib.h>   // For rand() and srand()
 #include <math.h>     // For mathematical functions like powf
+#include <string.h>   // For memcpy
+#include <new>        // For aligned operator new
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define ORBS_USE_AVX 1
+#define ORB_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ORBS_USE_SSE 1
+#define ORB_LANES 4
+#else
+#define ORB_LANES 1
+#endif
 
 // Constants for orb behavior (Non-editable for now)
 #define CENTER_SUCK_RADIUS  40.0f
@@ -11,6 +28,23 @@
 #define ORB_GLOW_RAMP       1.0f
 #define ORB_MIN_SIZE        5.0f
 #define ORB_RESPAWN         true
+#define ORB_TEXTURE_SIZE    64      // Disc sprite shared by every orb (sprite and batched paths)
+#define ORB_GROWTH_FACTOR   2       // Pool growth once the reserve is exceeded
+#define ORB_BATCH_QUADS     1024    // Quads per rlBegin/rlEnd run in the batched path
+#define ORB_CIRCLE_VERTICES 72      // DrawCircleV: 36 segments, emitted as 18 quads
+#define ORB_CACHE_LINE      64      // Position alignment, so ORB_CHUNK chunks never share a line
+#define ORB_RNG_SEED        0x5EEDu // Base seed of the respawn streams
+
+// Orb-orb interaction (spatial grid)
+#define ORB_CELL_SAMPLES    4       // Orbs looked at per neighbour cell per frame, keeps dense clumps O(n)
+#define ORB_MAX_PUSH        0.5f    // Largest interaction move per frame, in neighbour radii
+#define ORB_FLOCK_RADIUS    40.0f
+#define ORB_FLOCK_COHESION  0.05f   // Fraction of the way to the neighbour centroid per frame
+#define ORB_FLOCK_SPACING   0.4f    // Separation distance, in neighbour radii
+#define ORB_FLOCK_SEPARATION 2.0f   // Largest separation push per neighbour, pixels per frame
+#define ORB_COLLIDE_STIFFNESS 0.5f  // Push per pixel of offset between touching orbs (x 0.5..1 with the bass)
+#define ORB_CLUMP_RADIUS    60.0f
+#define ORB_CLUMP_FORCE     3.0f    // Largest pull per neighbour at full bass, pixels per frame
 
 // --- EDITABLE GLOBAL SETTINGS ---
 // Default values taken from your original defines
@@ -19,15 +53,68 @@ float orbMaxSize      = 20.0f;
 float mouseRepelForce = 5.0f;
 
 // Global variables (defined here)
-Orb* orbs = nullptr;  // Pointer to an array of orbs
+OrbField orbField = { nullptr, nullptr, 0, 0, ORB_MIN_SIZE, 255, WHITE };
 int orbCount = 0;     // Number of orbs
+int orbLimit = DEFAULT_MAX_PARTICLES;
+
+static int* suckedOrbs = nullptr;      // StepOrbs output, orbField.capacity entries
+static Texture2D orbTexture = { 0, 0, 0, 0, 0 };
+
+int orbRenderPath = ORB_RENDER_BATCHED;
+static OrbDrawStats orbDrawStats = { 0, 0, 0, 0, 0.0f };
+
+int orbThreads = 0;
+bool orbDeterministic = false;
+int orbInteraction = ORB_INTERACT_NONE;
+static OrbGrid orbGrid;
+static WorkerPool orbWorkers;
+static uint32_t orbFrame = 0;           // Deterministic streams are keyed on (frame, chunk)
+
+// Respawn RNG, one stream per pool thread, each on its own cache line
+struct alignas(ORB_CACHE_LINE) OrbRng {
+    uint64_t state;
+};
+static OrbRng orbRngs[WORKER_POOL_MAX_THREADS];
+static bool orbRngsSeeded = false;
+static std::vector<int> chunkSucked;    // Respawns per chunk in the last StepOrbsParallel
+
+static float* AllocOrbPositions(int count) {
+    return static_cast<float*>(::operator new(sizeof(float) * (size_t)count, std::align_val_t(ORB_CACHE_LINE), std::nothrow));
+}
+
+static void FreeOrbPositions(float* ptr) {
+    if (ptr) ::operator delete(ptr, std::align_val_t(ORB_CACHE_LINE));
+}
+
+// splitmix64: any seed (including consecutive ones) gives an independent-looking stream
+static inline uint32_t NextOrbRandom(OrbRng& rng) {
+    uint64_t z = (rng.state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+// RespawnOrb's placement (a random point just outside a random screen edge) from a private stream
+static void RespawnOrbFrom(OrbRng& rng, float* x, float* y, int index, Vector2 screen) {
+    uint32_t side = NextOrbRandom(rng) & 3u;
+    float u = (float)(NextOrbRandom(rng) >> 8) * (1.0f / 16777216.0f);
+    float alongX = -ORB_RESPAWN_MARGIN + u * (screen.x + 2.0f * ORB_RESPAWN_MARGIN);
+    float alongY = -ORB_RESPAWN_MARGIN + u * (screen.y + 2.0f * ORB_RESPAWN_MARGIN);
+
+    switch (side) {
+        case 0: x[index] = alongX; y[index] = -ORB_RESPAWN_MARGIN; break;
+        case 1: x[index] = alongX; y[index] = screen.y + ORB_RESPAWN_MARGIN; break;
+        case 2: x[index] = -ORB_RESPAWN_MARGIN; y[index] = alongY; break;
+        default: x[index] = screen.x + ORB_RESPAWN_MARGIN; y[index] = alongY; break;
+    }
+}
 
 // Respawn an orb at a random position on screen
-void RespawnOrb(Orb *orb) {
+void RespawnOrb(int index) {
     int screenWidth = GetScreenWidth();
     int screenHeight = GetScreenHeight();
     int side = GetRandomValue(0, 3);
-    float x, y;
+    float x = 0.0f, y = 0.0f;
 
     switch (side) {
         case 0: x = GetRandomValue(-ORB_RESPAWN_MARGIN, screenWidth + ORB_RESPAWN_MARGIN); y = -ORB_RESPAWN_MARGIN; break;
@@ -36,80 +123,566 @@ void RespawnOrb(Orb *orb) {
         case 3: x = screenWidth + ORB_RESPAWN_MARGIN; y = GetRandomValue(-ORB_RESPAWN_MARGIN, screenHeight + ORB_RESPAWN_MARGIN); break;
     }
 
-    orb->pos = (Vector2){ x, y };
-    orb->radius = ORB_MIN_SIZE;
-    orb->opacity = 255;
-    orb->color = WHITE;
+    orbField.x[index] = x;
+    orbField.y[index] = y;
+}
+
+// Grow the pool to hold at least `capacity` orbs. Growth is geometric (at least
+// ORB_GROWTH_FACTOR x), so a slider dragged upwards reallocates O(log n) times in total.
+// Active positions are carried over; nothing is respawned here.
+bool ReserveOrbs(int capacity) {
+    if (capacity > ORB_MAX_COUNT) capacity = ORB_MAX_COUNT;
+    if (capacity <= orbField.capacity) return true;
+
+    int grown = orbField.capacity * ORB_GROWTH_FACTOR;
+    if (grown > ORB_MAX_COUNT) grown = ORB_MAX_COUNT;
+    if (grown < capacity) grown = capacity;
+    grown = (grown + ORB_LANES - 1) / ORB_LANES * ORB_LANES;
+
+    float* x = AllocOrbPositions(grown);
+    float* y = AllocOrbPositions(grown);
+    int* sucked = (int*)malloc(sizeof(int) * grown);
+    if (!x || !y || !sucked) {
+        FreeOrbPositions(x);
+        FreeOrbPositions(y);
+        free(sucked);
+        return false;
+    }
+    if (orbField.active > 0) {
+        memcpy(x, orbField.x, sizeof(float) * orbField.active);
+        memcpy(y, orbField.y, sizeof(float) * orbField.active);
+    }
+    FreeOrbPositions(orbField.x);
+    FreeOrbPositions(orbField.y);
+    free(suckedOrbs);
+    orbField.x = x;
+    orbField.y = y;
+    suckedOrbs = sucked;
+    orbField.capacity = grown;
+    return true;
+}
+
+// Bring the active range in line with orbCount: clamp it, grow the pool if the
+// reserve is exceeded and respawn only the orbs that became active. Shrinking
+// just lowers the active count; orbs re-activated later are respawned again.
+static void SyncOrbCount() {
+    if (orbCount < 0) orbCount = 0;
+    if (orbCount > ORB_MAX_COUNT) orbCount = ORB_MAX_COUNT;
+    if (orbCount > orbField.capacity && !ReserveOrbs(orbCount)) orbCount = orbField.capacity;
+
+    for (int i = orbField.active; i < orbCount; i++) {
+        RespawnOrb(i);
+    }
+    orbField.active = orbCount;
 }
 
 // Initialize all orbs
 void InitOrbs(int maxOrbs) {
+    CloseOrbs();
+    if (maxOrbs < 0) maxOrbs = 0;
+    if (maxOrbs > ORB_MAX_COUNT) maxOrbs = ORB_MAX_COUNT;
+
+    // Reserve the whole slider range up front so dragging it never reallocates
+    orbLimit = maxOrbs;
+    ReserveOrbs(maxOrbs);
+    orbField.radius = ORB_MIN_SIZE;
+    orbField.opacity = 255;
+    orbField.color = WHITE;
+
     orbCount = maxOrbs;
-    orbs = (Orb*)malloc(sizeof(Orb) * orbCount);
+    SyncOrbCount();
+
+    orbWorkers.Start(ResolveWorkerThreads(orbThreads));
+}
+
+void CloseOrbs() {
+    orbWorkers.Stop();
+    FreeOrbPositions(orbField.x);
+    FreeOrbPositions(orbField.y);
+    free(suckedOrbs);
+    orbField.x = nullptr;
+    orbField.y = nullptr;
+    suckedOrbs = nullptr;
+    orbCount = 0;
+    orbField.capacity = 0;
+    orbField.active = 0;
+    if (orbTexture.id != 0) UnloadTexture(orbTexture);
+    orbTexture = (Texture2D){ 0, 0, 0, 0, 0 };
+}
+
+// One orb, in the same operation order as the vector paths.
+static inline bool StepOrb(float& x, float& y, const OrbStep& step) {
+    // Pull towards the center along the normalised direction
+    float dx = step.center.x - x;
+    float dy = step.center.y - y;
+    float dist = sqrtf(dx * dx + dy * dy);
+    if (dist == 0) dist = 1;
+    float inv = 1.0f / dist;
+    x += dx * inv * step.pullStrength;
+    y += dy * inv * step.pullStrength;
 
-    for (int i = 0; i < orbCount; i++) {
-        RespawnOrb(&orbs[i]);
+    // Mouse repulsion, fading out at MOUSE_REPEL_RADIUS
+    if (step.mouseActive) {
+        float rx = x - step.mouse.x;
+        float ry = y - step.mouse.y;
+        float mouseDist = sqrtf(rx * rx + ry * ry);
+        if (mouseDist < MOUSE_REPEL_RADIUS && mouseDist > 0.0f) {
+            float repelStrength = (1.0f - (mouseDist / MOUSE_REPEL_RADIUS)) * step.repelForce;
+            float rinv = 1.0f / mouseDist;
+            x += rx * rinv * repelStrength;
+            y += ry * rinv * repelStrength;
+        }
     }
+
+    float cx = x - step.center.x;
+    float cy = y - step.center.y;
+    return sqrtf(cx * cx + cy * cy) < CENTER_SUCK_RADIUS;
 }
 
-// Update orb positions and properties based on intensity
-void UpdateOrbs(float intensity, bool escape_mode, Color orbColor) {
-    int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
-    Vector2 center = { screenWidth / 2.0f, screenHeight / 2.0f };
-
-    // Get mouse position
-    Vector2 mouse = GetMousePosition();
-    bool mouseActive = IsCursorOnScreen();  // Check if mouse is within the window bounds
-
-    for (int i = 0; i < orbCount; i++) {
-        Orb *orb = &orbs[i];
-
-        // Calculate the direction from the orb to the center of the screen
-        Vector2 dir = Vector2Subtract(center, orb->pos);
-        float dist = Vector2Length(dir);
-        if (dist == 0) dist = 1;
-        dir = Vector2Scale(dir, 1.0f / dist); // Normalize the direction
-
-        // Apply gravitational pull towards the center
-        // REPLACED MACRO WITH VARIABLE: gravityStrength
-        float pullStrength = gravityStrength * intensity;
-        orb->pos = Vector2Add(orb->pos, Vector2Scale(dir, pullStrength));
-
-        // Mouse repulsion effect
-        if (mouseActive) {
-            float mouseDist = Vector2Distance(orb->pos, mouse);
-            if (mouseDist < MOUSE_REPEL_RADIUS) {
-                // Calculate the direction from the orb to the mouse
-                Vector2 repelDir = Vector2Subtract(orb->pos, mouse); // Orb should repel away from the mouse
-                // REPLACED MACRO WITH VARIABLE: mouseRepelForce
-                float repelStrength = (1.0f - (mouseDist / MOUSE_REPEL_RADIUS)) * mouseRepelForce;
-                orb->pos = Vector2Add(orb->pos, Vector2Scale(Vector2Normalize(repelDir), repelStrength));
+int StepOrbs(float* x, float* y, int count, const OrbStep& step, int* sucked) {
+    int suckedCount = 0;
+    int i = 0;
+
+#if defined(ORBS_USE_AVX)
+    const __m256 centerX = _mm256_set1_ps(step.center.x);
+    const __m256 centerY = _mm256_set1_ps(step.center.y);
+    const __m256 mouseX = _mm256_set1_ps(step.mouse.x);
+    const __m256 mouseY = _mm256_set1_ps(step.mouse.y);
+    const __m256 pull = _mm256_set1_ps(step.pullStrength);
+    const __m256 repel = _mm256_set1_ps(step.repelForce);
+    const __m256 repelRadius = _mm256_set1_ps(MOUSE_REPEL_RADIUS);
+    const __m256 suckRadius = _mm256_set1_ps(CENTER_SUCK_RADIUS);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_load_ps(x + i);
+        __m256 py = _mm256_load_ps(y + i);
+
+        __m256 dx = _mm256_sub_ps(centerX, px);
+        __m256 dy = _mm256_sub_ps(centerY, py);
+        __m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        dist = _mm256_blendv_ps(dist, one, _mm256_cmp_ps(dist, zero, _CMP_EQ_OQ));
+        __m256 inv = _mm256_div_ps(one, dist);
+        px = _mm256_add_ps(px, _mm256_mul_ps(_mm256_mul_ps(dx, inv), pull));
+        py = _mm256_add_ps(py, _mm256_mul_ps(_mm256_mul_ps(dy, inv), pull));
+
+        if (step.mouseActive) {
+            __m256 rx = _mm256_sub_ps(px, mouseX);
+            __m256 ry = _mm256_sub_ps(py, mouseY);
+            __m256 mouseDist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry)));
+            __m256 inside = _mm256_and_ps(_mm256_cmp_ps(mouseDist, repelRadius, _CMP_LT_OQ), _mm256_cmp_ps(mouseDist, zero, _CMP_GT_OQ));
+            if (_mm256_movemask_ps(inside)) {
+                __m256 strength = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_div_ps(mouseDist, repelRadius)), repel);
+                __m256 rinv = _mm256_div_ps(one, _mm256_blendv_ps(one, mouseDist, inside));
+                px = _mm256_add_ps(px, _mm256_and_ps(inside, _mm256_mul_ps(_mm256_mul_ps(rx, rinv), strength)));
+                py = _mm256_add_ps(py, _mm256_and_ps(inside, _mm256_mul_ps(_mm256_mul_ps(ry, rinv), strength)));
+            }
+        }
+
+        _mm256_store_ps(x + i, px);
+        _mm256_store_ps(y + i, py);
+
+        __m256 cx = _mm256_sub_ps(px, centerX);
+        __m256 cy = _mm256_sub_ps(py, centerY);
+        __m256 centerDist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(centerDist, suckRadius, _CMP_LT_OQ));
+        for (int lane = 0; mask; lane++, mask >>= 1) {
+            if (mask & 1) sucked[suckedCount++] = i + lane;
+        }
+    }
+#elif defined(ORBS_USE_SSE)
+    const __m128 centerX = _mm_set1_ps(step.center.x);
+    const __m128 centerY = _mm_set1_ps(step.center.y);
+    const __m128 mouseX = _mm_set1_ps(step.mouse.x);
+    const __m128 mouseY = _mm_set1_ps(step.mouse.y);
+    const __m128 pull = _mm_set1_ps(step.pullStrength);
+    const __m128 repel = _mm_set1_ps(step.repelForce);
+    const __m128 repelRadius = _mm_set1_ps(MOUSE_REPEL_RADIUS);
+    const __m128 suckRadius = _mm_set1_ps(CENTER_SUCK_RADIUS);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_load_ps(x + i);
+        __m128 py = _mm_load_ps(y + i);
+
+        __m128 dx = _mm_sub_ps(centerX, px);
+        __m128 dy = _mm_sub_ps(centerY, py);
+        __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        // SSE2 has no blend: (dist == 0) ? 1 : dist
+        __m128 isZero = _mm_cmpeq_ps(dist, zero);
+        dist = _mm_or_ps(_mm_and_ps(isZero, one), _mm_andnot_ps(isZero, dist));
+        __m128 inv = _mm_div_ps(one, dist);
+        px = _mm_add_ps(px, _mm_mul_ps(_mm_mul_ps(dx, inv), pull));
+        py = _mm_add_ps(py, _mm_mul_ps(_mm_mul_ps(dy, inv), pull));
+
+        if (step.mouseActive) {
+            __m128 rx = _mm_sub_ps(px, mouseX);
+            __m128 ry = _mm_sub_ps(py, mouseY);
+            __m128 mouseDist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)));
+            __m128 inside = _mm_and_ps(_mm_cmplt_ps(mouseDist, repelRadius), _mm_cmpgt_ps(mouseDist, zero));
+            if (_mm_movemask_ps(inside)) {
+                __m128 strength = _mm_mul_ps(_mm_sub_ps(one, _mm_div_ps(mouseDist, repelRadius)), repel);
+                __m128 safeDist = _mm_or_ps(_mm_and_ps(inside, mouseDist), _mm_andnot_ps(inside, one));
+                __m128 rinv = _mm_div_ps(one, safeDist);
+                px = _mm_add_ps(px, _mm_and_ps(inside, _mm_mul_ps(_mm_mul_ps(rx, rinv), strength)));
+                py = _mm_add_ps(py, _mm_and_ps(inside, _mm_mul_ps(_mm_mul_ps(ry, rinv), strength)));
             }
         }
 
-        // If the orb is within the sucking radius, respawn it
-        if (Vector2Distance(orb->pos, center) < CENTER_SUCK_RADIUS) {
-            if (ORB_RESPAWN) RespawnOrb(orb);  // Respawn orb if it gets close to center
-            else orb->opacity = orb->radius = 0;  // Hide the orb if not respawning
+        _mm_store_ps(x + i, px);
+        _mm_store_ps(y + i, py);
+
+        __m128 cx = _mm_sub_ps(px, centerX);
+        __m128 cy = _mm_sub_ps(py, centerY);
+        __m128 centerDist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(cx, cx), _mm_mul_ps(cy, cy)));
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(centerDist, suckRadius));
+        for (int lane = 0; mask; lane++, mask >>= 1) {
+            if (mask & 1) sucked[suckedCount++] = i + lane;
         }
+    }
+#endif
 
-        // Update orb size based on intensity
-        // REPLACED MACRO WITH VARIABLE: orbMaxSize
-        orb->radius = ORB_MIN_SIZE + intensity * orbMaxSize;
-        orb->opacity = (int)(intensity * 255);
-        orb->color = orbColor;
+    for (; i < count; i++) {
+        if (StepOrb(x[i], y[i], step)) sucked[suckedCount++] = i;
     }
+    return suckedCount;
 }
 
+int StepOrbsParallel(float* x, float* y, int count, const OrbStep& step, int* sucked,
+                     WorkerPool& pool, bool deterministic, uint32_t frame) {
+    if (count <= 0) return 0;
+    if (!orbRngsSeeded) {
+        for (int t = 0; t < WORKER_POOL_MAX_THREADS; t++) orbRngs[t].state = ORB_RNG_SEED + (uint64_t)t * 0x100000001ull;
+        orbRngsSeeded = true;
+    }
+
+    int chunks = (count + ORB_CHUNK - 1) / ORB_CHUNK;
+    if ((int)chunkSucked.size() < chunks) chunkSucked.resize(chunks);
+
+    pool.ParallelFor(chunks, [&](int chunk, int thread) {
+        int start = chunk * ORB_CHUNK;
+        int n = (start + ORB_CHUNK < count) ? ORB_CHUNK : count - start;
+        int* chunkOut = sucked + start;
+        int hits = StepOrbs(x + start, y + start, n, step, chunkOut);
+
+        if (ORB_RESPAWN && hits > 0) {
+            OrbRng local = { ((uint64_t)frame << 32) ^ (uint64_t)chunk ^ ((uint64_t)ORB_RNG_SEED << 16) };
+            OrbRng& rng = deterministic ? local : orbRngs[thread];
+            for (int s = 0; s < hits; s++) RespawnOrbFrom(rng, x + start, y + start, chunkOut[s], step.screen);
+        }
+        chunkSucked[chunk] = hits;
+    });
+
+    int total = 0;
+    for (int c = 0; c < chunks; c++) total += chunkSucked[c];
+    return total;
+}
+
+int RepelOrbs(float* x, float* y, const OrbGrid& grid, const OrbStep& step) {
+    const int* order = grid.GetOrder();
+    int pushed = 0;
+    grid.QueryRadius(step.mouse.x, step.mouse.y, MOUSE_REPEL_RADIUS, [&](int slot, float dx, float dy, float distSq) {
+        if (distSq <= 0.0f) return;
+        float mouseDist = sqrtf(distSq);
+        float repelStrength = (1.0f - (mouseDist / MOUSE_REPEL_RADIUS)) * step.repelForce;
+        float rinv = 1.0f / mouseDist;
+        x[order[slot]] += dx * rinv * repelStrength;
+        y[order[slot]] += dy * rinv * repelStrength;
+        pushed++;
+    });
+    return pushed;
+}
+
+// Neighbour forces for grid slots [start, end), one instantiation per mode so the
+// candidate loop carries no mode switch. Every force uses a (1 - d^2 / r^2) falloff
+// on the raw offset, so a candidate costs a few multiplies and no sqrt or divide;
+// candidates beyond the radius, and the orb itself (zero offset), add nothing.
+template <int Mode>
+static void InteractSlots(float* x, float* y, const OrbGrid& grid, const OrbInteract& params, int start, int end) {
+    const int* order = grid.GetOrder();
+    const float* sortedX = grid.GetSortedX();
+    const float* sortedY = grid.GetSortedY();
+    float radius = params.radius;
+    float maxPush = radius * ORB_MAX_PUSH;
+    float bass = fminf(fmaxf(params.bass, 0.0f), 1.0f);
+
+    // Falloff radius and the push a unit offset at zero distance gets
+    float reach = radius, gain = ORB_CLUMP_FORCE * bass / radius;
+    if (Mode == ORB_INTERACT_FLOCK) {
+        reach = radius * ORB_FLOCK_SPACING;
+        gain = -ORB_FLOCK_SEPARATION / reach;
+    } else if (Mode == ORB_INTERACT_COLLIDE) {
+        reach = fminf(params.contact, radius);
+        gain = -ORB_COLLIDE_STIFFNESS * (0.5f + 0.5f * bass);
+    }
+    float invRadiusSq = 1.0f / (radius * radius);
+    float invReachSq = 1.0f / (reach * reach);
+
+    for (int s = start; s < end; s++) {
+        float px = sortedX[s], py = sortedY[s];
+        float sumX = 0.0f, sumY = 0.0f, weight = 0.0f;     // Flock: weighted offsets to the neighbours
+        float pushX = 0.0f, pushY = 0.0f;
+
+        // Sample window start in [0, 2^32), scaled into each cell without a divide
+        uint32_t window = (params.frame + (uint32_t)s) * 2654435761u;
+
+        int x0 = grid.CellX(px - radius), x1 = grid.CellX(px + radius);
+        int y0 = grid.CellY(py - radius), y1 = grid.CellY(py + radius);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                // A dense cell contributes a window of ORB_CELL_SAMPLES orbs. The window
+                // start is hashed from (frame + slot), so neighbouring slots and successive
+                // frames see different members and every orb of the cell acts in turn.
+                int cell = cy * grid.GetCellsX() + cx;
+                int cellBegin = grid.GetCellBegin(cell);
+                int cellEnd = grid.GetCellEnd(cell);
+                int cellCount = cellEnd - cellBegin;
+                int samples = cellCount;
+                int first = cellBegin;
+                if (cellCount > ORB_CELL_SAMPLES) {
+                    samples = ORB_CELL_SAMPLES;
+                    first = cellBegin + (int)(((uint64_t)window * (uint32_t)cellCount) >> 32);
+                }
+                for (int k = 0; k < samples; k++) {
+                    int t = first + k;
+                    t -= (t >= cellEnd) ? cellCount : 0;
+                    float dx = sortedX[t] - px;
+                    float dy = sortedY[t] - py;
+                    float distSq = dx * dx + dy * dy;
+                    // max(v, 0) as (v + |v|) / 2: no libm fmaxf call and no branch, which
+                    // would mispredict on the random inside / outside pattern
+                    float near = 1.0f - distSq * invReachSq;
+                    near = (near + fabsf(near)) * 0.5f * gain;
+                    pushX += dx * near;
+                    pushY += dy * near;
+                    if (Mode == ORB_INTERACT_FLOCK) {
+                        float w = 1.0f - distSq * invRadiusSq;
+                        w = (w + fabsf(w)) * 0.5f;
+                        sumX += dx * w;
+                        sumY += dy * w;
+                        weight += w;
+                    }
+                }
+            }
+        }
+
+        // Flock cohesion: a step towards the weighted neighbour centroid, tighter on the bass
+        if (Mode == ORB_INTERACT_FLOCK && weight > 0.0f) {
+            float cohesion = ORB_FLOCK_COHESION * (0.2f + bass) / weight;
+            pushX += sumX * cohesion;
+            pushY += sumY * cohesion;
+        }
+
+        float pushSq = pushX * pushX + pushY * pushY;
+        if (pushSq > maxPush * maxPush) {
+            float scale = maxPush / sqrtf(pushSq);
+            pushX *= scale;
+            pushY *= scale;
+        }
+        x[order[s]] += pushX;
+        y[order[s]] += pushY;
+    }
+}
+
+void InteractOrbs(float* x, float* y, const OrbGrid& grid, const OrbInteract& params, WorkerPool& pool) {
+    int count = grid.GetCount();
+    if (count == 0 || params.mode == ORB_INTERACT_NONE) return;
+
+    // Slots are in cell order, so a chunk walks neighbouring cells that are already cached.
+    // Reads come from the grid's copy and each orb is written once: chunks are independent.
+    int chunks = (count + ORB_CHUNK - 1) / ORB_CHUNK;
+    pool.ParallelFor(chunks, [&](int chunk, int) {
+        int start = chunk * ORB_CHUNK;
+        int end = (start + ORB_CHUNK < count) ? start + ORB_CHUNK : count;
+        switch (params.mode) {
+            case ORB_INTERACT_FLOCK: InteractSlots<ORB_INTERACT_FLOCK>(x, y, grid, params, start, end); break;
+            case ORB_INTERACT_COLLIDE: InteractSlots<ORB_INTERACT_COLLIDE>(x, y, grid, params, start, end); break;
+            case ORB_INTERACT_CLUMP: InteractSlots<ORB_INTERACT_CLUMP>(x, y, grid, params, start, end); break;
+        }
+    });
+}
+
+// StepOrbs' center pull alone, in ORB_CHUNK chunks on `pool`. Its suck test
+// results are scratch: the caller tests again once every force has been applied.
+static void PullOrbs(float* x, float* y, int count, const OrbStep& step, int* scratch, WorkerPool& pool) {
+    OrbStep pull = step;
+    pull.mouseActive = false;
+    int chunks = (count + ORB_CHUNK - 1) / ORB_CHUNK;
+    pool.ParallelFor(chunks, [&](int chunk, int) {
+        int start = chunk * ORB_CHUNK;
+        int n = (start + ORB_CHUNK < count) ? ORB_CHUNK : count - start;
+        StepOrbs(x + start, y + start, n, pull, scratch + start);
+    });
+}
+
+static float GetInteractionRadius(int mode, float orbRadius) {
+    switch (mode) {
+        case ORB_INTERACT_FLOCK: return ORB_FLOCK_RADIUS;
+        case ORB_INTERACT_COLLIDE: return fmaxf(2.0f * orbRadius, ORB_GRID_MIN_CELL);
+        case ORB_INTERACT_CLUMP: return ORB_CLUMP_RADIUS;
+        default: return ORB_GRID_MIN_CELL;
+    }
+}
+
+const char* GetOrbInteractionName(int mode) {
+    switch (mode) {
+        case ORB_INTERACT_NONE: return "None";
+        case ORB_INTERACT_FLOCK: return "Flock";
+        case ORB_INTERACT_COLLIDE: return "Collide";
+        case ORB_INTERACT_CLUMP: return "Clump";
+        default: return "Unknown";
+    }
+}
+
+// Update orb positions and properties based on intensity
+void UpdateOrbs(float intensity, float bass, bool escape_mode, Color orbColor) {
+    OrbStep step;
+    step.center = (Vector2){ GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f };
+    step.mouse = GetMousePosition();
+    step.mouseActive = IsCursorOnScreen();  // Check if mouse is within the window bounds
+    // REPLACED MACRO WITH VARIABLE: gravityStrength / mouseRepelForce
+    step.pullStrength = gravityStrength * intensity;
+    step.repelForce = mouseRepelForce;
+    step.screen = (Vector2){ (float)GetScreenWidth(), (float)GetScreenHeight() };
+
+    // Update orb size based on intensity, once for the whole field
+    // REPLACED MACRO WITH VARIABLE: orbMaxSize
+    orbField.radius = ORB_MIN_SIZE + intensity * orbMaxSize;
+    orbField.opacity = (int)(intensity * 255);
+    orbField.color = orbColor;
+
+    // Slider changes land here, before any orb is touched this frame
+    SyncOrbCount();
+    orbFrame++;
+
+    // Interaction modes keep StepOrb's order (pull, mouse repel, suck test) with the
+    // neighbour forces between repel and suck test: the pull runs alone, the field is
+    // binned once, the mouse repel only visits the cells under the cursor, and the
+    // kernel below is left with the suck test and respawns.
+    if (orbInteraction != ORB_INTERACT_NONE && orbField.active > 0) {
+        PullOrbs(orbField.x, orbField.y, orbField.active, step, suckedOrbs, orbWorkers);
+
+        OrbInteract params = { orbInteraction, GetInteractionRadius(orbInteraction, orbField.radius), 2.0f * orbField.radius, bass, orbFrame };
+        orbGrid.Build(orbField.x, orbField.y, orbField.active, params.radius, -ORB_RESPAWN_MARGIN, -ORB_RESPAWN_MARGIN,
+                      step.screen.x + ORB_RESPAWN_MARGIN, step.screen.y + ORB_RESPAWN_MARGIN);
+        if (step.mouseActive) RepelOrbs(orbField.x, orbField.y, orbGrid, step);
+        InteractOrbs(orbField.x, orbField.y, orbGrid, params, orbWorkers);
+
+        // A zero pull leaves every position bit for bit as it is
+        step.pullStrength = 0.0f;
+        step.mouseActive = false;
+    }
+
+    if (orbWorkers.GetThreadCount() > 1 || orbDeterministic) {
+        StepOrbsParallel(orbField.x, orbField.y, orbField.active, step, suckedOrbs, orbWorkers, orbDeterministic, orbFrame);
+    } else {
+        int sucked = StepOrbs(orbField.x, orbField.y, orbField.active, step, suckedOrbs);
+
+        // Orbs within the sucking radius respawn (in index order, so the random sequence is unchanged)
+        if (ORB_RESPAWN) {
+            for (int s = 0; s < sucked; s++) RespawnOrb(suckedOrbs[s]);
+        }
+    }
+}
+
+// Antialiased white disc for the sprite paths, tinted per frame. One quad per orb instead
+// of DrawCircleV's triangle fan.
+static void LoadOrbTexture() {
+    Image disc = GenImageColor(ORB_TEXTURE_SIZE, ORB_TEXTURE_SIZE, BLANK);
+    Color* pixels = (Color*)disc.data;
+    float c = ORB_TEXTURE_SIZE / 2.0f;
+    for (int py = 0; py < ORB_TEXTURE_SIZE; py++) {
+        for (int px = 0; px < ORB_TEXTURE_SIZE; px++) {
+            float d = sqrtf((px + 0.5f - c) * (px + 0.5f - c) + (py + 0.5f - c) * (py + 0.5f - c));
+            float alpha = fminf(fmaxf(c - d, 0.0f), 1.0f);
+            pixels[py * ORB_TEXTURE_SIZE + px] = (Color){ 255, 255, 255, (unsigned char)(alpha * 255.0f) };
+        }
+    }
+    orbTexture = LoadTextureFromImage(disc);
+    UnloadImage(disc);
+    GenTextureMipmaps(&orbTexture);
+    SetTextureFilter(orbTexture, TEXTURE_FILTER_TRILINEAR);
+}
+
+// One quad per orb written straight into the rlgl vertex batch. Radius, color and UVs
+// are shared, so an orb costs four position pairs; the texture and mode stay bound
+// across runs, so rlgl only starts a new draw call when the batch buffer fills.
+static void DrawOrbsBatched(Color c, float r, OrbDrawStats& stats) {
+    rlSetTexture(orbTexture.id);
+    for (int start = 0; start < orbField.active; start += ORB_BATCH_QUADS) {
+        int end = start + ORB_BATCH_QUADS < orbField.active ? start + ORB_BATCH_QUADS : orbField.active;
+
+        // Flushes (and keeps the texture bound) if this run does not fit the batch
+        if (rlCheckRenderBatchLimit(4 * (end - start))) stats.batches++;
+
+        rlBegin(RL_QUADS);
+        rlColor4ub(c.r, c.g, c.b, c.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        for (int i = start; i < end; i++) {
+            float x0 = orbField.x[i] - r, x1 = orbField.x[i] + r;
+            float y0 = orbField.y[i] - r, y1 = orbField.y[i] + r;
+            rlTexCoord2f(0.0f, 0.0f); rlVertex2f(x0, y0);
+            rlTexCoord2f(0.0f, 1.0f); rlVertex2f(x0, y1);
+            rlTexCoord2f(1.0f, 1.0f); rlVertex2f(x1, y1);
+            rlTexCoord2f(1.0f, 0.0f); rlVertex2f(x1, y0);
+        }
+        rlEnd();
+        stats.submissions++;
+    }
+    rlSetTexture(0);
+    stats.vertices = 4 * orbField.active;
+}
 
 // Draw all orbs on the screen
 void DrawOrbs() {
-    for (int i = 0; i < orbCount; i++) {
-        Orb orb = orbs[i];
-        if (orb.opacity > 0 && orb.radius > 0.5f) {
-            Color c = { orb.color.r, orb.color.g, orb.color.b, (unsigned char)orb.opacity };
-            DrawCircleV(orb.pos, orb.radius, c);
+    double startTime = GetTime();
+    OrbDrawStats stats = { orbField.active, 0, 0, 0, 0.0f };
+    if (orbField.opacity <= 0 || orbField.radius <= 0.5f) {
+        orbDrawStats = (OrbDrawStats){ 0, 0, 0, 0, 0.0f };
+        return;
+    }
+    Color c = { orbField.color.r, orbField.color.g, orbField.color.b, (unsigned char)orbField.opacity };
+    float r = orbField.radius;
+    if (orbRenderPath == ORB_RENDER_CIRCLES) {
+        // The original renderer: a tessellated DrawCircleV per orb, no texture
+        for (int i = 0; i < orbField.active; i++) {
+            if (rlCheckRenderBatchLimit(ORB_CIRCLE_VERTICES)) stats.batches++;
+            DrawCircleV((Vector2){ orbField.x[i], orbField.y[i] }, r, c);
+        }
+        stats.submissions = orbField.active;
+        stats.vertices = ORB_CIRCLE_VERTICES * orbField.active;
+    } else if (orbRenderPath == ORB_RENDER_BATCHED) {
+        if (orbTexture.id == 0) LoadOrbTexture();
+        DrawOrbsBatched(c, r, stats);
+    } else {
+        // One DrawTexturePro per orb. The explicit limit check only counts the
+        // flushes the call would otherwise do on its own.
+        if (orbTexture.id == 0) LoadOrbTexture();
+        Rectangle source = { 0.0f, 0.0f, (float)orbTexture.width, (float)orbTexture.height };
+        for (int i = 0; i < orbField.active; i++) {
+            if (rlCheckRenderBatchLimit(4)) stats.batches++;
+            Rectangle dest = { orbField.x[i] - r, orbField.y[i] - r, 2.0f * r, 2.0f * r };
+            DrawTexturePro(orbTexture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, c);
         }
+        stats.submissions = orbField.active;
+        stats.vertices = 4 * orbField.active;
     }
-}
\ No newline at end of file
+
+    // The last batch is drawn with the rest of the frame
+    if (orbField.active > 0) stats.batches++;
+    stats.cpuUs = (float)((GetTime() - startTime) * 1e6);
+    orbDrawStats = stats;
+}
+
+OrbDrawStats GetOrbDrawStats() {
+    return orbDrawStats;
+}
+
+const char* GetOrbRenderPathName(int path) {
+    switch (path) {
+        case ORB_RENDER_BATCHED: return "Batched";
+        case ORB_RENDER_SPRITES: return "Sprites";
+        case ORB_RENDER_CIRCLES: return "Circles";
+        default: return "Unknown";
+    }
+}
@@ -3,28 +3,127 @@
 #define GRAVITYORBS_H
 
 #include "raylib.h"  // For Vector2, Color, and drawing functions
+#include "workerpool.h"
+#include "orbgrid.h"
+#include <cstdint>
 
-// Orb structure definition
+// Upper bound for --orbs; positions cost 8 bytes per orb
+#define ORB_MAX_COUNT       1000000
+
+// Orbs per parallel chunk: 16 KB of each coordinate, a whole number of cache lines
+// and SIMD steps, so chunks never share a line and lane grouping never changes
+#define ORB_CHUNK           4096
+
+// Orb pool, structure of arrays. Positions are FFT_ALIGNMENT aligned and padded to
+// a whole SIMD step; size, opacity and color are the same for every orb each frame
+// and are held once. orbCount (the menu slider) may change at any time; UpdateOrbs
+// folds it into `active` before touching any orb, so draws never see a resize.
 typedef struct {
-    Vector2 pos;
+    float* x;
+    float* y;
+    int capacity;       // Allocated positions (reserved up front, then grown geometrically)
+    int active;         // Orbs updated and drawn, [0, active)
     float radius;
     int opacity;
     Color color;
-} Orb;
+} OrbField;
+
+// Per-frame forces, shared by every orb.
+typedef struct {
+    Vector2 center;
+    Vector2 mouse;
+    bool mouseActive;
+    float pullStrength;     // gravityStrength * intensity
+    float repelForce;       // mouseRepelForce
+    Vector2 screen;         // Respawn bounds (StepOrbsParallel)
+} OrbStep;
+
+// How DrawOrbs submits the field. Circles is the original renderer; sprites swap the
+// triangle fan for a disc texture and batched writes those quads straight into rlgl.
+// Circles and sprites issue one raylib call per orb and are kept to compare against
+// (Debug menu).
+enum OrbRenderPath {
+    ORB_RENDER_BATCHED = 0,     // One textured quad per orb, runs of ORB_BATCH_QUADS per rlBegin
+    ORB_RENDER_SPRITES = 1,     // DrawTexturePro per orb
+    ORB_RENDER_CIRCLES = 2,     // DrawCircleV per orb (tessellated, untextured), the original renderer
+    ORB_RENDER_PATH_COUNT
+};
+
+// Cost of the last DrawOrbs call
+typedef struct {
+    int orbs;
+    int vertices;           // Vertices written to the rlgl batch
+    int submissions;        // rlBegin / rlEnd runs (raylib draw calls from our side)
+    int batches;            // GPU draw calls the orbs span (batch flushes + the final one)
+    float cpuUs;            // Time spent in DrawOrbs
+} OrbDrawStats;
 
 // Function declarations
-void RespawnOrb(Orb *orb);
-void InitOrbs(int maxOrbs);
-void UpdateOrbs(float intensity, bool escape_mode, Color orbColor);
+void RespawnOrb(int index);
+void InitOrbs(int maxOrbs);     // Reserves and activates maxOrbs (also the slider range)
+bool ReserveOrbs(int capacity); // False if the pool could not grow (it is left as it was)
+void CloseOrbs();
+void UpdateOrbs(float intensity, float bass, bool escape_mode, Color orbColor);
 void DrawOrbs();
+OrbDrawStats GetOrbDrawStats();
+const char* GetOrbRenderPathName(int path);
+
+// Center pull, mouse repel and suck-radius test for orbs [0, count), SSE/AVX when
+// available. `x` and `y` must be FFT_ALIGNMENT aligned (AllocAlignedFloats). Writes the indices of orbs that reached the center to `sucked` (room
+// for `count`) in ascending order and returns how many there were. No raylib state
+// is touched, so the kernel runs without a window (see --bench orbs).
+int StepOrbs(float* x, float* y, int count, const OrbStep& step, int* sucked);
+
+// StepOrbs over ORB_CHUNK chunks spread across `pool`, with the sucked orbs respawned
+// inside each chunk from per-thread RNG streams. With `deterministic` every chunk
+// draws from a stream keyed on (frame, chunk) instead, so the field evolves the same
+// for any thread count and schedule. `sucked` is scratch (room for `count`); returns
+// the number of respawned orbs. Touches no raylib state (see --bench orbthreads).
+int StepOrbsParallel(float* x, float* y, int count, const OrbStep& step, int* sucked,
+                     WorkerPool& pool, bool deterministic, uint32_t frame);
+
+// Orb-orb interaction on top of the center pull, driven by the bass. Each mode bins
+// the field into an OrbGrid every frame and looks at no more than a capped number
+// of neighbours per orb, so the cost stays linear in the orb count.
+enum OrbInteraction {
+    ORB_INTERACT_NONE = 0,      // Pull and mouse repel only (StepOrbs, no grid)
+    ORB_INTERACT_FLOCK = 1,     // Cohesion towards the neighbours (tighter on the bass) and separation
+    ORB_INTERACT_COLLIDE = 2,   // Overlapping discs push apart (stiffer on the bass)
+    ORB_INTERACT_CLUMP = 3,     // Neighbours attract in proportion to the bass
+    ORB_INTERACTION_COUNT
+};
+
+typedef struct {
+    int mode;               // OrbInteraction
+    float radius;           // Neighbour radius; the grid must be built with this cell size
+    float contact;          // Collision distance (two orb radii)
+    float bass;             // 0..1
+    uint32_t frame;         // Rotates which orbs of a dense cell are sampled
+} OrbInteract;
+
+// Moves every orb of `grid` (built over x / y) by its neighbour forces. Neighbours
+// are read from the grid's copy, so orbs move as of the same instant and the
+// ORB_CHUNK chunks run in parallel on `pool`.
+void InteractOrbs(float* x, float* y, const OrbGrid& grid, const OrbInteract& params, WorkerPool& pool);
+
+// StepOrbs' mouse repel, visiting only the grid cells within MOUSE_REPEL_RADIUS
+// of the cursor. Returns the number of orbs pushed.
+int RepelOrbs(float* x, float* y, const OrbGrid& grid, const OrbStep& step);
+
+const char* GetOrbInteractionName(int mode);
 
 // Extern declarations for global variables
-extern Orb* orbs;     // Pointer to an array of orbs
-extern int orbCount;  // Number of orbs
+extern OrbField orbField;
+extern int orbCount;  // Requested orbs (the menu slider); the pool follows on the next UpdateOrbs
+extern int orbLimit;  // Orbs reserved by InitOrbs and slider maximum (--orbs, default DEFAULT_MAX_PARTICLES)
+extern int orbRenderPath; // OrbRenderPath, ORB_RENDER_BATCHED by default
+extern int orbThreads;    // Update threads, read by InitOrbs (--orb-threads, 0 = auto, 1 = serial)
+extern bool orbDeterministic; // Respawns independent of thread count (--deterministic-orbs)
+extern int orbInteraction;    // OrbInteraction, ORB_INTERACT_NONE by default (gravity menu)
 
 // --- NEW EDITABLE SETTINGS ---
 extern float gravityStrength; // Was GRAVITY_RAMP
 extern float orbMaxSize;      // Was ORB_MAX_SIZE
 extern float mouseRepelForce; // Was MOUSE_REPEL_FORCE
 
-#endif // GRAVITYORBS_H
\ No newline at end of file
+#endif // GRAVITYORBS_H
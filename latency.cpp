@@ -0,0 +1,107 @@
+#include "latency.h"
+#include <atomic>
+#include <cstdio>
+
+#define LATENCY_BUCKETS ((int)(LATENCY_MAX_MS / LATENCY_BUCKET_MS))
+
+static const char* latencyStageNames[LATENCY_STAGE_COUNT] = { "Queued", "Analysed", "Sent", "Presented" };
+
+const char* GetLatencyStageName(int stage) {
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) return "Unknown";
+    return latencyStageNames[stage];
+}
+
+struct LatencyHistogram {
+    std::atomic<uint32_t> buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> sumUs;
+    std::atomic<uint64_t> maxUs;
+};
+
+static LatencyHistogram histograms[LATENCY_STAGE_COUNT];
+
+void RecordLatency(int stage, double seconds) {
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) return;
+    if (seconds < 0.0) seconds = 0.0;
+
+    LatencyHistogram& h = histograms[stage];
+    double ms = seconds * 1000.0;
+    int bucket = (int)(ms / LATENCY_BUCKET_MS);
+    if (bucket >= LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+
+    // Single writer per stage, so plain load/store pairs are enough for max
+    uint64_t us = (uint64_t)(seconds * 1e6);
+    h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    h.sumUs.fetch_add(us, std::memory_order_relaxed);
+    if (us > h.maxUs.load(std::memory_order_relaxed)) h.maxUs.store(us, std::memory_order_relaxed);
+}
+
+static float PercentileMs(const uint32_t* buckets, uint64_t total, double fraction) {
+    uint64_t target = (uint64_t)(fraction * (double)total);
+    if (target >= total) target = total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen > target) return (float)((b + 1) * LATENCY_BUCKET_MS);
+    }
+    return (float)LATENCY_MAX_MS;
+}
+
+static uint64_t SnapshotBuckets(int stage, uint32_t* buckets) {
+    LatencyHistogram& h = histograms[stage];
+    uint64_t total = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        buckets[b] = h.buckets[b].load(std::memory_order_relaxed);
+        total += buckets[b];
+    }
+    return total;
+}
+
+LatencyStats GetLatencyStats(int stage) {
+    LatencyStats stats;
+    if (stage < 0 || stage >= LATENCY_STAGE_COUNT) return stats;
+
+    static thread_local uint32_t buckets[LATENCY_BUCKETS];
+    uint64_t total = SnapshotBuckets(stage, buckets);
+    if (total == 0) return stats;
+
+    LatencyHistogram& h = histograms[stage];
+    stats.count = total;
+    stats.meanMs = (float)(h.sumUs.load(std::memory_order_relaxed) / 1000.0 / (double)total);
+    stats.p50Ms = PercentileMs(buckets, total, 0.50);
+    stats.p95Ms = PercentileMs(buckets, total, 0.95);
+    stats.p99Ms = PercentileMs(buckets, total, 0.99);
+    stats.maxMs = (float)(h.maxUs.load(std::memory_order_relaxed) / 1000.0);
+    return stats;
+}
+
+void ResetLatencyStats() {
+    for (LatencyHistogram& h : histograms) {
+        for (std::atomic<uint32_t>& bucket : h.buckets) bucket.store(0, std::memory_order_relaxed);
+        h.sumUs.store(0, std::memory_order_relaxed);
+        h.maxUs.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool DumpLatencyStats(const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+
+    fprintf(out, "stage,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        LatencyStats stats = GetLatencyStats(s);
+        fprintf(out, "%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f\n", GetLatencyStageName(s), (unsigned long long)stats.count,
+                stats.meanMs, stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+    }
+
+    static thread_local uint32_t buckets[LATENCY_BUCKETS];
+    fprintf(out, "\nstage,bucket_ms,count\n");
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        SnapshotBuckets(s, buckets);
+        for (int b = 0; b < LATENCY_BUCKETS; b++) {
+            if (buckets[b] > 0) fprintf(out, "%s,%.1f,%u\n", GetLatencyStageName(s), b * LATENCY_BUCKET_MS, buckets[b]);
+        }
+    }
+
+    fclose(out);
+    return true;
+}
@@ -0,0 +1,46 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <cstdint>
+
+// =========================================================
+// END-TO-END LATENCY
+// =========================================================
+// Every audio block carries the time its first sample hit the ADC, on the
+// AnalysisClockNow() clock. Each stage records (now - captureTime) when the block
+// reaches it, so every histogram is cumulative from capture.
+
+enum LatencyStage {
+    LATENCY_QUEUED,         // Dequeued by the analysis thread
+    LATENCY_ANALYSED,       // FFT, bands, beat and glow smoothing done
+    LATENCY_SENT,           // Light packet handed to the socket
+    LATENCY_PRESENTED,      // First frame showing the block returned from EndDrawing
+    LATENCY_STAGE_COUNT
+};
+
+// 0.1 ms buckets up to LATENCY_MAX_MS; slower samples land in the last bucket (max stays exact).
+#define LATENCY_BUCKET_MS 0.1
+#define LATENCY_MAX_MS    500.0
+
+const char* GetLatencyStageName(int stage);
+
+struct LatencyStats {
+    uint64_t count = 0;
+    float meanMs = 0.0f;
+    float p50Ms = 0.0f;
+    float p95Ms = 0.0f;
+    float p99Ms = 0.0f;
+    float maxMs = 0.0f;
+};
+
+// Lock free. Each stage must only be recorded from one thread at a time.
+void RecordLatency(int stage, double seconds);
+
+// Safe from any thread; percentiles are resolved to the bucket upper edge.
+LatencyStats GetLatencyStats(int stage);
+void ResetLatencyStats();
+
+// Summary plus the non-empty buckets of every stage as CSV. Returns false if the file cannot be written.
+bool DumpLatencyStats(const char* path);
+
+#endif // LATENCY_H
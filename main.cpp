@@ -4,12 +4,8 @@
 #define NOUSER
 #define NOWINRES
 
-#define BASS_LOW_FREQ       35.0f
-#define BASS_HIGH_FREQ      75.0f
-#define BASS_NORM_FACTOR    275.0f
-#define BASS_BOOST_EXPONENT 2.0f
-#define GLOW_MIX            0.275f
 #define SMOOTH_SPEED        15.0f
+#define BEAT_BURST_PARTICLES 40
 
 const char* VERSION = "Development 0.5.1";
 
@@ -18,16 +14,28 @@ const char* VERSION = "Development 0.5.1";
 #include <ws2tcpip.h>
 #include "raylib.h"
 #include "raymath.h"
-#include <portaudio.h>
-#include "kiss_fft.h"
+#include "fft.h"
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
 #include <chrono>
 #include "gravityorbs.h"
 #include "Waveform.h"
 #include "networking.h"
 #include <vector>
+#include <algorithm>
 #include "globals.h"
+#include "audioring.h"
+#include "analysis.h"
+#include "benchmark.h"
+#include "offline.h"
+#include "audiosource.h"
+#include "latency.h"
+#include "audiohealth.h"
+#include "capture.h"
+#include "color.h"
+#include "spectrogramview.h"
 #include "imgui.h"
 #include "menu.h"
 #include "cube.h"
@@ -36,9 +44,6 @@ const char* VERSION = "Development 0.5.1";
 #include "IdleGame/IdleGame.h"
 #include "Menu/IdleGameMenu/IdleGameMenu.h"
 
-#define SAMPLE_RATE         44100
-#define FFT_SIZE            FRAMES_PER_BUFFER
-
 enum VisualizationMode {
     WAVEFORM_MODE,
     GRAVITY_MODE,
@@ -46,77 +51,51 @@ enum VisualizationMode {
     PARTICLE_MODE_01,
 };
 
-static int MyAudioCallback(const void *inputBuffer, void *outputBuffer,
-    unsigned long framesPerBuffer,
-    const PaStreamCallbackTimeInfo* timeInfo,
-    PaStreamCallbackFlags statusFlags,
-    void *userData) {
-    if (inputBuffer != NULL) {
-        const float *in = (const float*) inputBuffer;
-        for (unsigned int i = 0; i < framesPerBuffer; i++) {
-            gAudioBuffer[i] = in[i];
-        }
-        audioDataReady = 1;
+Particle01 particleSystem(MAX_PARTICLES);
+
+int main(int argc, char** argv) {
+    // --- COMMAND LINE MODES (no window, no audio device) ---
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return RunBenchmarks(argc > 2 ? argv[2] : nullptr);
     }
-    return paContinue;
-}
-
-float ProcessFFT() {
-    kiss_fft_cfg cfg = kiss_fft_alloc(FFT_SIZE, 0, NULL, NULL);
-    if (!cfg) return 0.0f;
-
-    kiss_fft_cpx in_fft[FFT_SIZE];
-    kiss_fft_cpx out_fft[FFT_SIZE];
-    for (int i = 0; i < FFT_SIZE; i++) {
-        in_fft[i].r = gAudioBuffer[i];
-        in_fft[i].i = 0;
+    if (argc > 1 && strcmp(argv[1], "--analyze") == 0) {
+        return RunOfflineAnalysis(argc - 1, argv + 1);
     }
-    kiss_fft(cfg, in_fft, out_fft);
-    free(cfg);
-
-    float freqRes = SAMPLE_RATE / (float)FFT_SIZE;
-    int   lowBin  = (int)(BASS_LOW_FREQ / freqRes);
-    int   highBin = (int)(BASS_HIGH_FREQ / freqRes);
-    float sumBass = 0.0f;
-    int   count   = 0;
-
-    for (int i = lowBin; i <= highBin; i++) {
-        float mag = sqrtf(out_fft[i].r * out_fft[i].r + out_fft[i].i * out_fft[i].i);
-        sumBass += mag;
-        count++;
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        return RunHeadless(argc - 1, argv + 1);
     }
-
-    float avgBass = (count > 0) ? (sumBass / (float)count) : 0.0f;
-    float normalized = avgBass / BASS_NORM_FACTOR;
-    if (normalized > 1.0f) normalized = 1.0f;
-    if (normalized < 0.0f) normalized = 0.0f;
-
-    return powf(normalized, BASS_BOOST_EXPONENT);
-}
-
-Color HSVtoRGB(float h, float s, float v) {
-    float r, g, b;
-    int i = (int)(h * 6.0f);
-    float f = h * 6.0f - i;
-    float p = v * (1.0f - s);
-    float q = v * (1.0f - f * s);
-    float t = v * (1.0f - (1.0f - f) * s);
-
-    switch (i % 6) {
-        case 0: r = v; g = t; b = p; break;
-        case 1: r = q; g = v; b = p; break;
-        case 2: r = p; g = v; b = t; break;
-        case 3: r = p; g = q; b = v; break;
-        case 4: r = t; g = p; b = v; break;
-        case 5: r = v; g = p; b = q; break;
+    if (argc > 1 && strcmp(argv[1], "--compare-capture") == 0) {
+        return RunCaptureCompare(argc - 1, argv + 1);
     }
-    return (Color){ (unsigned char)(r * 255), (unsigned char)(g * 255), (unsigned char)(b * 255), 255 };
-}
 
-Particle01 particleSystem(MAX_PARTICLES);
+    AudioSourceConfig sourceConfig;
+    if (!ParseAudioSourceArgs(argc, argv, sourceConfig)) return 1;
 
-int main() {
     float renderGlow             = 0.0f;
+    uint64_t presentedBlocks     = 0;      // Snapshot whose first present has been timed
+    const char* latencyOut       = nullptr;
+    const char* healthOut        = nullptr;
+    const char* recordPath       = nullptr;
+    bool showSpectrogram         = false;
+    float appliedPump            = 1.0f;   // AnalysisSettings::pump default
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--latency-out") == 0) latencyOut = argv[i + 1];
+        if (strcmp(argv[i], "--health-out") == 0) healthOut = argv[i + 1];
+        if (strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+        if (strcmp(argv[i], "--orbs") == 0) orbLimit = atoi(argv[i + 1]);
+        if (strcmp(argv[i], "--orb-threads") == 0) orbThreads = atoi(argv[i + 1]);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--deterministic-orbs") == 0) orbDeterministic = true;
+    }
+    if (orbLimit < 1 || orbLimit > ORB_MAX_COUNT) {
+        fprintf(stderr, "--orbs must be 1..%d\n", ORB_MAX_COUNT);
+        return 1;
+    }
+    if (orbThreads < 0 || orbThreads > WORKER_POOL_MAX_THREADS) {
+        fprintf(stderr, "--orb-threads must be 0 (auto) or 1..%d\n", WORKER_POOL_MAX_THREADS);
+        return 1;
+    }
 
     Waveform waveform(128, 0.5f, 1.0f, brightnessFloor, glow_value, 1.0f, 0.0f);
     Menu menu;
@@ -132,6 +111,9 @@ int main() {
 
     particleSystem.Init();
 
+    SpectrogramView spectrogramView;
+    spectrogramView.Init();
+
     Camera3D camera = { 0 };
     camera.position   = { 10.0f, 10.0f, 10.0f };
     camera.target     = { 0.0f,  0.0f,  0.0f  };
@@ -145,11 +127,16 @@ int main() {
     int prevY = cubeSettings.gridY;
     int prevZ = cubeSettings.gridZ;
 
-    InitOrbs(DEFAULT_MAX_PARTICLES);
-    Pa_Initialize();
-    PaStream* stream;
-    Pa_OpenDefaultStream(&stream, 1, 0, paFloat32, SAMPLE_RATE, FRAMES_PER_BUFFER, MyAudioCallback, NULL);
-    Pa_StartStream(stream);
+    InitOrbs(orbLimit);
+    // Started before the analysis thread so the capture holds the very first block.
+    // A capture that cannot be created is reported and the show goes on without it.
+    if (recordPath) StartCaptureRecording(recordPath);
+    SetLightOutput(SendToPython);
+    StartAnalysisThread();
+    AudioSource* audioSource = CreateAudioSource(sourceConfig);
+    if (!audioSource || !audioSource->Start()) {
+        fprintf(stderr, "Cannot start audio source '%s'\n", GetAudioSourceName(sourceConfig.type));
+    }
 
     VisualizationMode currentMode = WAVEFORM_MODE;
 
@@ -162,6 +149,10 @@ int main() {
             enableInterpolation = !enableInterpolation;
         }
 
+        if (IsKeyPressed(KEY_S)) {
+            showSpectrogram = !showSpectrogram;
+        }
+
         if (cubeSettings.gridX != prevX || cubeSettings.gridY != prevY || cubeSettings.gridZ != prevZ) {
             cubeField = GenerateCubeField(cubeSettings);
             prevX = cubeSettings.gridX;
@@ -169,14 +160,22 @@ int main() {
             prevZ = cubeSettings.gridZ;
         }
 
-        if (audioDataReady) {
-            audioDataReady = 0;
-            float boostedBass = ProcessFFT();
-
-            // --- GLOBAL PUMP APPLICATION ---
-            float pumpedBass = boostedBass * globalPump;
-            glow_value = glow_value * (1.0f - GLOW_MIX) + pumpedBass * GLOW_MIX;
+        // Format changes from the Debug menu restart only the audio source
+        if (TakeAudioFormatRequest(sourceConfig)) {
+            if (audioSource) audioSource->Stop();
+            delete audioSource;
+            ResetAudioHealthStats();
+            audioSource = CreateAudioSource(sourceConfig);
+            if (!audioSource || !audioSource->Start()) {
+                fprintf(stderr, "Cannot restart audio source at %d Hz / %d frames\n", sourceConfig.sampleRate, sourceConfig.blockFrames);
+            }
         }
+        if (audioSource) RecordAudioCpuLoad(audioSource->GetCpuLoad());
+
+        // Analysis runs on its own thread; the frame only picks up the latest result.
+        // Read in place: the triple buffer keeps this frame untouched until the next acquire
+        const VisualFrame& analysis = AcquireVisualFrame();
+        glow_value = analysis.glow;
 
         float dt = GetFrameTime();
         if (enableInterpolation) {
@@ -185,7 +184,6 @@ int main() {
             renderGlow = glow_value;
         }
 
-        float finalBrightness = brightnessFloor + (renderGlow * (1.0f - brightnessFloor));
         float visualGlow = fminf(powf(renderGlow, 1.0f), 1.0f);
 
         if (autoCycleHue) {
@@ -193,10 +191,30 @@ int main() {
             if (hueShift >= 360.0f) hueShift -= 360.0f;
         }
 
+        // The menu writes these on this thread; the analysis thread only sees them through here
+        if (globalPump != appliedPump) {
+            AnalysisSettings settings = GetAnalysisSettings();
+            settings.pump = globalPump;
+            SetAnalysisSettings(settings);
+            appliedPump = globalPump;
+        }
+        SetLightOutputLevels(brightnessFloor, hueShift);
+
         idleGame.Update(dt, visualGlow);
-        Color orbColor = HSVtoRGB(hueShift / 360.0f, 1.0f, 1.0f);
-        UpdateOrbs(visualGlow, escape_mode, orbColor);
-        SendToPython(finalBrightness, hueShift / 360.0f);
+        Color orbColor = HueToColor(hueShift);
+        UpdateOrbs(visualGlow, analysis.bass, escape_mode, orbColor);
+
+        // Beat events fire particle bursts on the kick instead of waiting for the glow to rise
+        BeatEvent beatEvent;
+        while (gBeatRing.Pop(beatEvent)) {
+            if (currentMode == PARTICLE_MODE_01) {
+                int burst = beatEvent.predicted ? BEAT_BURST_PARTICLES / 2 : BEAT_BURST_PARTICLES;
+                particleSystem.TriggerBurst(burst, orbColor, fmaxf(visualGlow, analysis.bass));
+            }
+        }
+
+        // Keep the texture current even while hidden: a few columns per frame is cheaper than a full resend on toggle
+        spectrogramView.Update(gSpectrogram);
 
         BeginDrawing();
         ClearBackground(BLACK);
@@ -219,8 +237,7 @@ int main() {
             EndMode3D();
         }
         else if (currentMode == WAVEFORM_MODE) {
-            std::vector<float> audioVector(std::begin(gAudioBuffer), std::end(gAudioBuffer));
-            waveform.drawWaveform(audioVector, orbColor);
+            waveform.drawWaveform(analysis.GetPCM(), orbColor);
         }
         else if (currentMode == GRAVITY_MODE) {
             DrawOrbs();
@@ -243,6 +260,12 @@ int main() {
             EndMode3D();
         }
 
+        if (showSpectrogram) {
+            float height = GetScreenHeight() * 0.25f;
+            Rectangle bounds = { 0.0f, GetScreenHeight() - height, (float)GetScreenWidth(), height };
+            spectrogramView.Draw(bounds, orbColor);
+        }
+
         float screenH = (float)GetScreenHeight();
         float uiScale = (screenH > 1080.0f) ? 1.25f : 1.0f;
         idleGameMenu.Draw(idleGame, uiScale);
@@ -250,11 +273,29 @@ int main() {
         menu.Draw((int)currentMode);
 
         EndDrawing();
+
+        // Capture-to-photon: time each snapshot on the first frame that shows it
+        if (analysis.blocks > 0 && analysis.blocks != presentedBlocks) {
+            RecordLatency(LATENCY_PRESENTED, AnalysisClockNow() - analysis.captureTime);
+            presentedBlocks = analysis.blocks;
+        }
+    }
+
+    if (latencyOut && !DumpLatencyStats(latencyOut)) {
+        fprintf(stderr, "Cannot write latency stats to '%s'\n", latencyOut);
+    }
+    if (healthOut && !DumpAudioHealthStats(healthOut)) {
+        fprintf(stderr, "Cannot write audio health stats to '%s'\n", healthOut);
     }
 
-    Pa_StopStream(stream);
-    Pa_CloseStream(stream);
-    Pa_Terminate();
+    if (audioSource) audioSource->Stop();
+    delete audioSource;
+    StopAnalysisThread();
+    StopCaptureRecording();
+    spectrogramView.Unload();
+    CloseOrbs();
+    ClearWindowTables();
+    CloseFFT();
     WSACleanup();
     CloseWindow();
     return 0;
@@ -10,7 +10,6 @@
 #include "cube.h"
 #include "networking.h"
 
-extern int orbCount;
 extern float hueShift;
 extern float gravityStrength;
 extern float orbMaxSize;
@@ -54,7 +53,7 @@ Menu::Menu()
       editingHue(false),
       scrollOffset(0.0f),
       lifxConnected(false),
-      orbSlider(1, 1250, orbCount, 1250, "Orbs", hueShift),
+      orbSlider(1, orbLimit, orbCount, orbLimit, "Orbs", hueShift),
       brightnessSlider(0.0f, 1.0f, brightnessFloor, 0.0f, "Floor", hueShift),
       gravitySlider(0.1f, 25.0f, gravityStrength, 18.0f, "Gravity", hueShift),
       sizeSlider(0.1f, 100.0f, orbMaxSize, 20.0f, "Max Size", hueShift),
@@ -197,12 +196,25 @@ float Menu::DrawMenuContent(float offsetX, float offsetY, Rectangle visibleArea,
             repelSlider.DrawSlider(sliderRect, visibleArea, uiScale);
             offsetY += paddingMedium;
 
+            // Orb-orb interaction: click to cycle
+            Rectangle interactRect = { offsetX + paddingStandard, offsetY, (float)(GetMenuBounds().width - (paddingStandard * 2)), rowHeight };
+            bool hoverInteract = CheckCollisionPointRec(mousePos, interactRect);
+            if (hoverInteract && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+                orbInteraction = (orbInteraction + 1) % ORB_INTERACTION_COUNT;
+            }
+            DrawRectangleRounded(interactRect, 0.3f, 4, Fade(hoverInteract ? DARKGREEN : DARKGRAY, backgroundAlpha));
+            const char* interactText = TextFormat("Interaction: %s", GetOrbInteractionName(orbInteraction));
+            DrawText(interactText, (int)(interactRect.x + (interactRect.width - MeasureText(interactText, fontButton)) / 2),
+                     (int)(interactRect.y + (interactRect.height - fontButton) / 2), fontButton, WHITE);
+            offsetY += paddingMedium;
+
             float btnWidth = 100.0f * uiScale;
             float btnHeight = 25.0f * uiScale;
             Rectangle resetBtnRect = { (offsetX + GetMenuBounds().width)/2.0f - btnWidth/2.0f, offsetY, btnWidth, btnHeight };
             bool hoverReset = CheckCollisionPointRec(mousePos, resetBtnRect);
             if (hoverReset && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                orbCount = 1250; gravityStrength = 18.0f; orbMaxSize = 20.0f; mouseRepelForce = 5.0f;
+                orbCount = orbLimit; gravityStrength = 18.0f; orbMaxSize = 20.0f; mouseRepelForce = 5.0f;
+                orbInteraction = ORB_INTERACT_NONE;
             }
             DrawRectangleRounded(resetBtnRect, 0.3f, 4, Fade(hoverReset ? RED : MAROON, backgroundAlpha));
             const char* resetText = "RESET ALL";
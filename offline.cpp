@@ -0,0 +1,350 @@
+#include "offline.h"
+#include "analysis.h"
+#include "wavfile.h"
+#include "audiosource.h"
+#include "audioring.h"
+#include "latency.h"
+#include "audiohealth.h"
+#include "capture.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Binary timeline: 8-byte magic, uint32 field count, uint32 sample rate, then one
+// float record of OFFLINE_FIELD_COUNT values per analysed block.
+#define OFFLINE_BINARY_MAGIC "VBSTL01"
+#define OFFLINE_FIELD_COUNT  (5 + NUM_BANDS + 1)
+
+#define HEADLESS_DEFAULT_SECONDS 30
+#define HEADLESS_POLL_MS         5
+
+static void PrintOfflineUsage() {
+    fprintf(stderr,
+            "usage: VisualBassSync --analyze <file.wav> [--out path] [--binary]\n"
+            "       [--mode block|stft|sdft|decim] [--fft n] [--hop n] [--window hann|blackman]\n"
+            "       [--block n] [--block-fft n] [--decimate n]\n"
+            "       [--norm f] [--boost f] [--glow-mix f]\n"
+            "       [--auto-gain] [--gain-percentile f] [--attack sec] [--release sec]\n");
+}
+
+static bool ParseMode(const char* name, int& mode) {
+    if (strcmp(name, "block") == 0)     mode = ANALYSIS_BLOCK_FFT;
+    else if (strcmp(name, "stft") == 0) mode = ANALYSIS_STFT;
+    else if (strcmp(name, "sdft") == 0) mode = ANALYSIS_SLIDING_DFT;
+    else if (strcmp(name, "decim") == 0) mode = ANALYSIS_DECIMATED;
+    else return false;
+    return true;
+}
+
+static bool ParseWindow(const char* name, int& window) {
+    if (strcmp(name, "hann") == 0)          window = WINDOW_HANN;
+    else if (strcmp(name, "blackman") == 0) window = WINDOW_BLACKMAN;
+    else return false;
+    return true;
+}
+
+// Fields: time, glow, bass, onset, bpm, bands..., beat
+static void FillRecord(float* record, const AnalysisSnapshot& snapshot, double time, bool beat) {
+    record[0] = (float)time;
+    record[1] = snapshot.glow;
+    record[2] = snapshot.bass;
+    record[3] = snapshot.onset;
+    record[4] = snapshot.bpm;
+    for (int b = 0; b < NUM_BANDS; b++) {
+        record[5 + b] = snapshot.bands[b];
+    }
+    record[5 + NUM_BANDS] = beat ? 1.0f : 0.0f;
+}
+
+static void WriteCsvHeader(FILE* out) {
+    fprintf(out, "time,glow,bass,onset,bpm");
+    for (int b = 0; b < NUM_BANDS; b++) {
+        fprintf(out, ",%s", GetBandName(b));
+    }
+    fprintf(out, ",beat\n");
+}
+
+static void WriteCsvRecord(FILE* out, const float* record) {
+    fprintf(out, "%.6f", record[0]);
+    for (int i = 1; i < OFFLINE_FIELD_COUNT - 1; i++) {
+        fprintf(out, ",%.6f", record[i]);
+    }
+    fprintf(out, ",%d\n", (int)record[OFFLINE_FIELD_COUNT - 1]);
+}
+
+int RunOfflineAnalysis(int argc, char** argv) {
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    bool binary = false;
+    int blockFrames = FRAMES_PER_BUFFER;
+    AnalysisSettings settings;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool ok = true;
+
+        if (strcmp(arg, "--binary") == 0) { binary = true; continue; }
+        if (strcmp(arg, "--auto-gain") == 0) { settings.autoGain = true; continue; }
+
+        if (arg[0] != '-' || arg[1] != '-') {
+            inputPath = arg;
+            continue;
+        }
+        if (!value) ok = false;
+        else if (strcmp(arg, "--out") == 0)      outputPath = value;
+        else if (strcmp(arg, "--mode") == 0)     ok = ParseMode(value, settings.mode);
+        else if (strcmp(arg, "--fft") == 0)      settings.stftSize = atoi(value);
+        else if (strcmp(arg, "--hop") == 0)      settings.stftHop = atoi(value);
+        else if (strcmp(arg, "--block") == 0)    blockFrames = atoi(value);
+        else if (strcmp(arg, "--block-fft") == 0) settings.blockFftSize = atoi(value);
+        else if (strcmp(arg, "--decimate") == 0) settings.decimation = atoi(value);
+        else if (strcmp(arg, "--window") == 0)   ok = ParseWindow(value, settings.stftWindow);
+        else if (strcmp(arg, "--norm") == 0)     settings.bassNorm = (float)atof(value);
+        else if (strcmp(arg, "--boost") == 0)    settings.bassBoost = (float)atof(value);
+        else if (strcmp(arg, "--glow-mix") == 0) settings.glowMix = (float)atof(value);
+        else if (strcmp(arg, "--gain-percentile") == 0) settings.gainPercentile = (float)atof(value);
+        else if (strcmp(arg, "--attack") == 0)   settings.gainAttack = (float)atof(value);
+        else if (strcmp(arg, "--release") == 0)  settings.gainRelease = (float)atof(value);
+        else ok = false;
+
+        if (!ok) {
+            fprintf(stderr, "Bad option '%s'\n", arg);
+            PrintOfflineUsage();
+            return 1;
+        }
+        i++;
+    }
+
+    if (!inputPath) {
+        PrintOfflineUsage();
+        return 1;
+    }
+    if (settings.bassNorm <= 0.0f || settings.glowMix <= 0.0f || settings.glowMix > 1.0f) {
+        fprintf(stderr, "--norm must be > 0 and --glow-mix in (0, 1]\n");
+        return 1;
+    }
+    if (blockFrames < 1 || blockFrames > FRAMES_PER_BUFFER || settings.blockFftSize < 2 || (settings.blockFftSize & 1)) {
+        fprintf(stderr, "--block must be 1..%d and --block-fft even\n", FRAMES_PER_BUFFER);
+        return 1;
+    }
+    if (settings.decimation < DECIMATE_MIN_FACTOR || settings.decimation > DECIMATE_MAX_FACTOR) {
+        fprintf(stderr, "--decimate must be %d..%d\n", DECIMATE_MIN_FACTOR, DECIMATE_MAX_FACTOR);
+        return 1;
+    }
+    if (settings.gainPercentile <= 0.0f || settings.gainPercentile > 1.0f || settings.gainAttack < 0.0f || settings.gainRelease < 0.0f) {
+        fprintf(stderr, "--gain-percentile must be in (0, 1] and --attack / --release >= 0\n");
+        return 1;
+    }
+
+    WavReader wav;
+    if (!wav.Open(inputPath)) {
+        fprintf(stderr, "Cannot read '%s': %s\n", inputPath, wav.GetError());
+        return 1;
+    }
+    int sampleRate = wav.GetSampleRate();
+
+    FILE* out = stdout;
+    if (outputPath) {
+        out = fopen(outputPath, binary ? "wb" : "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open '%s' for writing\n", outputPath);
+            return 1;
+        }
+    }
+
+    if (binary) {
+        char magic[8] = OFFLINE_BINARY_MAGIC;
+        uint32_t header[2] = { (uint32_t)OFFLINE_FIELD_COUNT, (uint32_t)sampleRate };
+        fwrite(magic, 1, sizeof(magic), out);
+        fwrite(header, sizeof(uint32_t), 2, out);
+    } else {
+        WriteCsvHeader(out);
+    }
+
+    SetAnalysisSettings(settings);
+    AudioAnalyzer analyzer;
+    BeatRing beats;
+    analyzer.SetBeatOutput(&beats);
+
+    AudioBlock block = {};
+    block.sampleRate = sampleRate;
+    block.blockFrames = blockFrames;
+    float record[OFFLINE_FIELD_COUNT];
+    uint64_t blocks = 0;
+    uint64_t totalFrames = 0;
+    uint64_t beatTotal = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    int frames;
+    while ((frames = wav.ReadMono(block.samples, blockFrames)) > 0) {
+        block.frames = (unsigned long)frames;
+        block.sequence = blocks;
+        const AnalysisSnapshot& snapshot = analyzer.ProcessBlock(block);
+
+        bool beat = false;
+        BeatEvent event;
+        while (beats.Pop(event)) {
+            beat = true;
+            beatTotal++;
+        }
+
+        totalFrames += (uint64_t)frames;
+        double time = (double)totalFrames / sampleRate;
+        FillRecord(record, snapshot, time, beat);
+        if (binary) fwrite(record, sizeof(float), OFFLINE_FIELD_COUNT, out);
+        else        WriteCsvRecord(out, record);
+        blocks++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (out != stdout) fclose(out);
+    SetAnalysisSettings(AnalysisSettings());
+
+    // The mode the analyzer actually ran: a size or factor it cannot use falls back
+    const AnalysisSettings& applied = analyzer.GetSettings();
+    char modeName[48];
+    if (applied.mode == ANALYSIS_DECIMATED) {
+        snprintf(modeName, sizeof(modeName), "%s /%d", GetAnalysisModeName(applied.mode), applied.decimation);
+    } else {
+        snprintf(modeName, sizeof(modeName), "%s", GetAnalysisModeName(applied.mode));
+    }
+
+    double audioSeconds = (double)totalFrames / sampleRate;
+    fprintf(stderr, "[analyze] %s: %d Hz, %llu blocks (%.1f s), %llu beats, %.0f x realtime (%s)\n",
+            inputPath,
+            sampleRate,
+            (unsigned long long)blocks,
+            audioSeconds,
+            (unsigned long long)beatTotal,
+            seconds > 0.0 ? audioSeconds / seconds : 0.0,
+            modeName);
+    return 0;
+}
+
+int RunHeadless(int argc, char** argv) {
+    AudioSourceConfig config;
+    config.type = AUDIO_SOURCE_GENERATOR;
+    if (!ParseAudioSourceArgs(argc, argv, config)) return 1;
+
+    double seconds = HEADLESS_DEFAULT_SECONDS;
+    const char* latencyOut = nullptr;
+    const char* healthOut = nullptr;
+    const char* recordPath = nullptr;
+    bool secondsGiven = false;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--seconds") == 0) {
+            seconds = atof(argv[i + 1]);
+            secondsGiven = true;
+        }
+        if (strcmp(argv[i], "--latency-out") == 0) latencyOut = argv[i + 1];
+        if (strcmp(argv[i], "--health-out") == 0) healthOut = argv[i + 1];
+        if (strcmp(argv[i], "--record") == 0) recordPath = argv[i + 1];
+    }
+    if (config.type != AUDIO_SOURCE_PORTAUDIO) config.maxFrames = (uint64_t)(seconds * config.sampleRate);
+    uint64_t targetSamples = (uint64_t)(seconds * config.sampleRate);
+    // A replay runs to the end of its capture unless --seconds cuts it short
+    if (config.type == AUDIO_SOURCE_REPLAY && !secondsGiven) {
+        config.maxFrames = 0;
+        targetSamples = UINT64_MAX;
+    }
+
+    if (recordPath && !StartCaptureRecording(recordPath)) return 1;
+    AudioSource* source = CreateAudioSource(config);
+    StartAnalysisThread();
+    if (!source || !source->Start()) {
+        fprintf(stderr, "Cannot start audio source '%s'\n", GetAudioSourceName(config.type));
+        StopAnalysisThread();
+        StopCaptureRecording();
+        delete source;
+        return 1;
+    }
+    fprintf(stderr, "[headless] source: %s%s%s, %s\n",
+            source->GetName(),
+            config.type == AUDIO_SOURCE_GENERATOR ? " " : "",
+            config.type == AUDIO_SOURCE_GENERATOR ? GetSignalName(config.signal) : "",
+            config.unthrottled ? "unthrottled" : "realtime");
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t beatTotal = 0;
+    uint64_t nextReport = config.sampleRate;
+    AnalysisSnapshot snapshot;
+
+    while (true) {
+        BeatEvent event;
+        while (gBeatRing.Pop(event)) beatTotal++;
+
+        // Unthrottled runs skip the per-second lines: they would sample the snapshot at
+        // arbitrary points and break run-to-run reproducibility.
+        snapshot = GetLatestAnalysis();
+        while (!config.unthrottled && snapshot.samplePosition >= nextReport) {
+            printf("%6.1f s  glow %.3f  bass %.3f  bpm %6.1f  beats %llu",
+                   (double)nextReport / config.sampleRate, snapshot.glow, snapshot.bass, snapshot.bpm,
+                   (unsigned long long)beatTotal);
+            for (int c = 0; snapshot.channels > 1 && c < snapshot.channels; c++) {
+                printf("  ch%d %.3f", c, snapshot.channel[c].bass);
+            }
+            if (snapshot.channels > 1) printf("  side %.3f", snapshot.side.bass);
+            printf("\n");
+            nextReport += config.sampleRate;
+        }
+
+        RecordAudioCpuLoad(source->GetCpuLoad());
+        if (snapshot.samplePosition >= targetSamples) break;
+        if (source->IsFinished() && gAudioRing.Empty()) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(HEADLESS_POLL_MS));
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    source->Stop();
+    delete source;
+    StopAnalysisThread();
+    StopCaptureRecording();
+
+    BeatEvent event;
+    while (gBeatRing.Pop(event)) beatTotal++;
+    snapshot = GetLatestAnalysis();
+
+    double audioSeconds = (double)snapshot.samplePosition / config.sampleRate;
+    printf("[headless] %.1f s of audio, %d ch, %llu blocks, %llu beats, bpm %.1f, %llu overruns\n",
+           audioSeconds,
+           snapshot.channels,
+           (unsigned long long)snapshot.blocks,
+           (unsigned long long)beatTotal,
+           snapshot.bpm,
+           (unsigned long long)gAudioRing.Overruns());
+    for (int c = 0; snapshot.channels > 1 && c < snapshot.channels; c++) {
+        printf("[headless] ch%d glow %.3f  bass %.3f\n", c, snapshot.channel[c].glow, snapshot.channel[c].bass);
+    }
+    if (snapshot.channels > 1) printf("[headless] side glow %.3f  bass %.3f\n", snapshot.side.glow, snapshot.side.bass);
+    fprintf(stderr, "[headless] %.2f s wall clock, %.0f x realtime\n",
+            wallSeconds, wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0);
+
+    for (int s = 0; s < LATENCY_STAGE_COUNT; s++) {
+        LatencyStats stats = GetLatencyStats(s);
+        if (stats.count == 0) continue;
+        fprintf(stderr, "[headless] latency %-9s p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f ms\n",
+                GetLatencyStageName(s), stats.p50Ms, stats.p95Ms, stats.p99Ms, stats.maxMs);
+    }
+    AudioHealthStats health = GetAudioHealthStats();
+    fprintf(stderr, "[headless] health: %llu callbacks, %llu overflows, %llu underflows, %llu dropped, %llu late\n",
+            (unsigned long long)health.callbacks, (unsigned long long)health.inputOverflows,
+            (unsigned long long)health.inputUnderflows, (unsigned long long)health.droppedBlocks,
+            (unsigned long long)health.lateCallbacks);
+    fprintf(stderr, "[headless] callback interval %.2f ms (period %.2f, max %.2f, jitter rms %.3f), cost %.1f us (max %.1f), cpu %.1f%%\n",
+            health.intervalMeanMs, health.blockPeriodMs, health.intervalMaxMs, health.jitterRmsMs,
+            health.callbackMeanUs, health.callbackMaxUs, health.cpuLoadMax * 100.0f);
+
+    if (latencyOut && !DumpLatencyStats(latencyOut)) {
+        fprintf(stderr, "Cannot write latency stats to '%s'\n", latencyOut);
+        return 1;
+    }
+    if (healthOut && !DumpAudioHealthStats(healthOut)) {
+        fprintf(stderr, "Cannot write audio health stats to '%s'\n", healthOut);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef OFFLINE_H
+#define OFFLINE_H
+
+// =========================================================
+// HEADLESS OFFLINE ANALYSIS
+// =========================================================
+// Run with `VisualBassSync --analyze <file.wav> [options]`. Streams the file through
+// the same AudioAnalyzer the live path uses, block by block, and writes the glow /
+// band / beat timeline without opening a window or an audio device.
+//
+//   --out <path>         Output file (default: stdout)
+//   --binary             Packed float records instead of CSV
+//   --mode <m>           block | stft | sdft | decim
+//   --fft <n> --hop <n>  STFT size and hop
+//   --block <n>          Frames per analysed block (default FRAMES_PER_BUFFER)
+//   --block-fft <n>      Block FFT mode analysis size
+//   --decimate <n>       Decimation factor of the decim mode (see decimator.h)
+//   --window <w>         hann | blackman
+//   --norm <f>           Bass normalisation factor
+//   --boost <f>          Bass boost exponent
+//   --glow-mix <f>       Glow smoothing mix
+//   --auto-gain          Adaptive per-band normalisation (see autogain.h)
+//   --gain-percentile <f> --attack <sec> --release <sec>
+//
+// The summary on stderr names the mode the analyzer actually ran, after any fallback.
+
+// `argv` starts at the `--analyze` flag itself.
+int RunOfflineAnalysis(int argc, char** argv);
+
+// =========================================================
+// HEADLESS LIVE PIPELINE
+// =========================================================
+// Run with `VisualBassSync --headless [--seconds n] [--source ...] [--channels n]
+// [--sample-rate hz] [--block frames] [--unthrottled] [--latency-out path] [--health-out path]
+// [--replay capture] [--record capture]`.
+// Starts the analysis thread and an AudioSource (see audiosource.h) exactly as the
+// windowed app does, prints one status line per second of audio and a summary.
+// A replay runs the whole capture unless --seconds is given; re-recording it and
+// running --compare-capture (see capture.h) against the original is a regression test.
+// With a generator source and --unthrottled stdout is deterministic; timing and
+// latency percentiles and callback health (see audiohealth.h) go to stderr.
+
+int RunHeadless(int argc, char** argv);
+
+#endif // OFFLINE_H
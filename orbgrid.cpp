@@ -0,0 +1,53 @@
+#include "orbgrid.h"
+#include <cmath>
+
+OrbGrid::OrbGrid()
+    : count(0), cellSize(ORB_GRID_MIN_CELL), invCellSize(1.0f / ORB_GRID_MIN_CELL),
+      originX(0.0f), originY(0.0f), cellsX(1), cellsY(1), cellStart(2, 0) {}
+
+void OrbGrid::Build(const float* x, const float* y, int orbCount, float size,
+                    float minX, float minY, float maxX, float maxY) {
+    count = orbCount > 0 ? orbCount : 0;
+    cellSize = size > ORB_GRID_MIN_CELL ? size : ORB_GRID_MIN_CELL;
+    float width = maxX > minX ? maxX - minX : 1.0f;
+    float height = maxY > minY ? maxY - minY : 1.0f;
+    while ((width / cellSize + 1.0f) * (height / cellSize + 1.0f) > ORB_GRID_MAX_CELLS) cellSize *= 2.0f;
+
+    invCellSize = 1.0f / cellSize;
+    originX = minX;
+    originY = minY;
+    cellsX = (int)ceilf(width * invCellSize);
+    cellsY = (int)ceilf(height * invCellSize);
+    if (cellsX < 1) cellsX = 1;
+    if (cellsY < 1) cellsY = 1;
+    int cells = cellsX * cellsY;
+
+    // resize() only allocates when the field or the grid outgrows the last frame
+    cellStart.assign(cells + 1, 0);
+    if ((int)order.size() < count) {
+        cellOf.resize(count);
+        order.resize(count);
+        sortedX.resize(count);
+        sortedY.resize(count);
+    }
+
+    // Count, shifted by one so the prefix sum leaves each cell's start in place
+    for (int i = 0; i < count; i++) {
+        int cell = CellY(y[i]) * cellsX + CellX(x[i]);
+        cellOf[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (int c = 0; c < cells; c++) cellStart[c + 1] += cellStart[c];
+
+    // Scatter in index order, so each cell keeps its orbs sorted by index
+    for (int i = 0; i < count; i++) {
+        int slot = cellStart[cellOf[i]]++;
+        order[slot] = i;
+        sortedX[slot] = x[i];
+        sortedY[slot] = y[i];
+    }
+
+    // The scatter advanced every start to the next cell's start; shift back
+    for (int c = cells; c > 0; c--) cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
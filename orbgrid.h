@@ -0,0 +1,87 @@
+#ifndef ORBGRID_H
+#define ORBGRID_H
+
+#include <vector>
+
+// =========================================================
+// ORB SPATIAL HASH GRID
+// =========================================================
+// Uniform grid over the orb positions, rebuilt every frame by a counting sort:
+// one pass to count orbs per cell, a prefix sum, one pass to scatter. Positions
+// are copied in cell order, so a neighbour query reads a few contiguous runs
+// instead of the whole field. Orbs outside the bounds land in the nearest border
+// cell; queries clamp the same way, so nothing is ever missed, only tested.
+
+#define ORB_GRID_MIN_CELL   8.0f        // Smallest cell side in pixels
+#define ORB_GRID_MAX_CELLS  (1 << 20)   // The cell size grows past this many cells
+
+class OrbGrid {
+public:
+    OrbGrid();
+
+    // Bin orbs [0, count) into square cells of (at least) `cellSize` over
+    // [minX, maxX) x [minY, maxY). Storage grows and is then reused.
+    void Build(const float* x, const float* y, int count, float cellSize,
+               float minX, float minY, float maxX, float maxY);
+
+    int GetCount() const { return count; }
+    float GetCellSize() const { return cellSize; }
+    int GetCellsX() const { return cellsX; }
+    int GetCellsY() const { return cellsY; }
+
+    // Clamped cell coordinates of a point. Truncation instead of floor is fine:
+    // everything in (-1, 0) clamps to cell 0 either way.
+    int CellX(float x) const {
+        float cx = (x - originX) * invCellSize;
+        return cx <= 0.0f ? 0 : (cx >= (float)(cellsX - 1) ? cellsX - 1 : (int)cx);
+    }
+    int CellY(float y) const {
+        float cy = (y - originY) * invCellSize;
+        return cy <= 0.0f ? 0 : (cy >= (float)(cellsY - 1) ? cellsY - 1 : (int)cy);
+    }
+
+    // Slots [GetCellBegin(c), GetCellEnd(c)) of cell c = cy * GetCellsX() + cx
+    int GetCellBegin(int cell) const { return cellStart[cell]; }
+    int GetCellEnd(int cell) const { return cellStart[cell + 1]; }
+
+    // Per slot, in cell order: the orb index and its position at Build time
+    const int* GetOrder() const { return order.data(); }
+    const float* GetSortedX() const { return sortedX.data(); }
+    const float* GetSortedY() const { return sortedY.data(); }
+
+    // Calls visit(slot, dx, dy, distSq) for every orb within `radius` of (px, py),
+    // where (dx, dy) points from the query to the orb.
+    template <typename Visit>
+    void QueryRadius(float px, float py, float radius, Visit visit) const {
+        if (count == 0) return;
+        float radiusSq = radius * radius;
+        int x0 = CellX(px - radius), x1 = CellX(px + radius);
+        int y0 = CellY(py - radius), y1 = CellY(py + radius);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int cell = cy * cellsX + cx;
+                for (int s = cellStart[cell]; s < cellStart[cell + 1]; s++) {
+                    float dx = sortedX[s] - px;
+                    float dy = sortedY[s] - py;
+                    float distSq = dx * dx + dy * dy;
+                    if (distSq < radiusSq) visit(s, dx, dy, distSq);
+                }
+            }
+        }
+    }
+
+private:
+    int count;
+    float cellSize;
+    float invCellSize;
+    float originX, originY;
+    int cellsX, cellsY;
+
+    std::vector<int> cellStart;     // cells + 1 entries
+    std::vector<int> cellOf;        // Cell of each orb (Build scratch)
+    std::vector<int> order;
+    std::vector<float> sortedX;
+    std::vector<float> sortedY;
+};
+
+#endif // ORBGRID_H
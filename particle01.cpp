@@ -54,6 +54,13 @@ void Particle01::Spawn3DParticle(Color baseColor, float glowValue) {
     particles.push_back(p);
 }
 
+void Particle01::TriggerBurst(int count, Color baseColor, float glowValue) {
+    if (!isInitialized) return;
+    for (int i = 0; i < count; i++) {
+        Spawn3DParticle(baseColor, glowValue);
+    }
+}
+
 void Particle01::Update(float deltaTime, float glowValue, Color orbColor) {
     if (!isInitialized) return;
 
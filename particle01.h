@@ -22,6 +22,9 @@ public:
     void Update(float deltaTime, float glowValue, Color orbColor);
     void Draw(Camera3D camera);
 
+    // Spawn `count` particles at once (beat bursts), capped by maxParticles.
+    void TriggerBurst(int count, Color baseColor, float glowValue);
+
 private:
     void Spawn3DParticle(Color baseColor, float glowValue);
 
@@ -0,0 +1,91 @@
+#include "slidingdft.h"
+#include "fft.h"
+#include <cmath>
+#include <cstring>
+
+static const double TWO_PI = 6.283185307179586;
+
+SlidingDFT::SlidingDFT()
+    : size(0), numBins(0), firstBin(0), delay(nullptr), delayPos(0), dampingN(1.0)
+{
+    Reset();
+}
+
+SlidingDFT::~SlidingDFT() {
+    FreeAligned(delay);
+}
+
+bool SlidingDFT::Configure(int newSize, float sampleRate, float lowFreq, float highFreq) {
+    if (newSize <= 0 || sampleRate <= 0.0f) return false;
+
+    float freqRes = sampleRate / (float)newSize;
+    int lowBin  = (int)(lowFreq / freqRes);
+    int highBin = (int)(highFreq / freqRes);
+    int count = highBin - lowBin + 1;
+    if (count <= 0) return false;
+    if (count > SDFT_MAX_BINS) count = SDFT_MAX_BINS;
+
+    if (newSize != size) {
+        FreeAligned(delay);
+        delay = AllocAlignedFloats(newSize);
+        if (!delay) {
+            size = 0;
+            return false;
+        }
+    }
+
+    size = newSize;
+    firstBin = lowBin;
+    numBins = count;
+    dampingN = pow(SDFT_DAMPING, (double)size);
+    for (int k = 0; k < numBins; k++) {
+        double angle = TWO_PI * (double)(firstBin + k) / (double)size;
+        twiddleR[k] = SDFT_DAMPING * cos(angle);
+        twiddleI[k] = SDFT_DAMPING * sin(angle);
+    }
+
+    Reset();
+    return true;
+}
+
+void SlidingDFT::Reset() {
+    if (delay) memset(delay, 0, sizeof(float) * size);
+    delayPos = 0;
+    for (int k = 0; k < SDFT_MAX_BINS; k++) {
+        stateR[k] = 0.0;
+        stateI[k] = 0.0;
+    }
+}
+
+void SlidingDFT::Process(const float* samples, int count) {
+    if (!delay) return;
+
+    for (int n = 0; n < count; n++) {
+        // X_k <- r * e^(j2pik/N) * (X_k + x[n] - r^N * x[n-N])
+        double x = (double)samples[n];
+        double delta = x - dampingN * (double)delay[delayPos];
+        delay[delayPos] = samples[n];
+        if (++delayPos == size) delayPos = 0;
+
+        for (int k = 0; k < numBins; k++) {
+            double re = stateR[k] + delta;
+            double im = stateI[k];
+            stateR[k] = re * twiddleR[k] - im * twiddleI[k];
+            stateI[k] = re * twiddleI[k] + im * twiddleR[k];
+        }
+    }
+}
+
+float SlidingDFT::GetMeanMagnitude() const {
+    if (numBins <= 0) return 0.0f;
+
+    double sum = 0.0;
+    for (int k = 0; k < numBins; k++) {
+        sum += sqrt(stateR[k] * stateR[k] + stateI[k] * stateI[k]);
+    }
+    return (float)(sum / numBins) * ((float)FFT_SIZE / (float)size);
+}
+
+float SlidingDFT::GetBassLevel() const {
+    return BoostBassLevel(GetMeanMagnitude(), BASS_NORM_FACTOR, BASS_BOOST_EXPONENT);
+}
@@ -0,0 +1,49 @@
+#ifndef SLIDINGDFT_H
+#define SLIDINGDFT_H
+
+// =========================================================
+// SLIDING DFT BASS TRACKER
+// =========================================================
+// Tracks only the DFT bins covering BASS_LOW_FREQ..BASS_HIGH_FREQ of a virtual
+// SDFT_SIZE-point transform. Each input sample updates every tracked bin in
+// O(bins), so the bass magnitude is current at every sample with no FFT at all.
+// A damping factor just below 1 keeps float rounding from accumulating.
+
+#define SDFT_SIZE       4096        // 10.8 Hz bins at 44.1 kHz
+#define SDFT_MAX_BINS   16
+#define SDFT_DAMPING    0.999999
+
+class SlidingDFT {
+public:
+    SlidingDFT();
+    ~SlidingDFT();
+
+    bool Configure(int size, float sampleRate, float lowFreq, float highFreq);
+    void Reset();
+
+    // Per-sample update of all tracked bins.
+    void Process(const float* samples, int count);
+
+    // Mean magnitude of the tracked bins, scaled to an unwindowed FFT_SIZE block.
+    float GetMeanMagnitude() const;
+
+    // Same normalisation and boost as ComputeBassLevel.
+    float GetBassLevel() const;
+
+    int GetSize() const { return size; }
+    int GetBinCount() const { return numBins; }
+
+private:
+    int size;
+    int numBins;
+    int firstBin;
+    float* delay;           // Last `size` input samples
+    int delayPos;
+    double dampingN;        // SDFT_DAMPING ^ size
+    double twiddleR[SDFT_MAX_BINS];
+    double twiddleI[SDFT_MAX_BINS];
+    double stateR[SDFT_MAX_BINS];
+    double stateI[SDFT_MAX_BINS];
+};
+
+#endif // SLIDINGDFT_H
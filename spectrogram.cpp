@@ -0,0 +1,83 @@
+#include "spectrogram.h"
+#include "fft.h"
+#include <cmath>
+#include <cstring>
+
+// A full-scale sine reads FFT_SIZE / 2 in an FFT_SIZE-referenced spectrum: 0 dB.
+static const float FULL_SCALE_MAGNITUDE = FFT_SIZE * 0.5f;
+
+SpectrogramRing::SpectrogramRing() : mapBins(0), mapBinHz(0.0f), written(0) {
+    data = new uint8_t[(size_t)SPECTROGRAM_COLUMNS * SPECTROGRAM_ROWS];
+    memset(data, 0, (size_t)SPECTROGRAM_COLUMNS * SPECTROGRAM_ROWS);
+    memset(rowFirst, 0, sizeof(rowFirst));
+    memset(rowLast, 0, sizeof(rowLast));
+    memset(rowFreq, 0, sizeof(rowFreq));
+}
+
+SpectrogramRing::~SpectrogramRing() {
+    delete[] data;
+}
+
+// Log-spaced rows from SPECTROGRAM_MIN_FREQ to Nyquist. A row narrower than a bin
+// reads the bin holding its bottom edge, so low rows repeat coarse bins instead of
+// going dark.
+void SpectrogramRing::BuildRowMap(int bins, float binHz) {
+    mapBins = bins;
+    mapBinHz = binHz;
+
+    float nyquist = (bins - 1) * binHz;
+    float minFreq = (SPECTROGRAM_MIN_FREQ < nyquist) ? SPECTROGRAM_MIN_FREQ : nyquist * 0.5f;
+    float ratio = nyquist / minFreq;
+    for (int r = 0; r <= SPECTROGRAM_ROWS; r++) {
+        rowFreq[r] = minFreq * powf(ratio, (float)r / (float)SPECTROGRAM_ROWS);
+    }
+
+    for (int r = 0; r < SPECTROGRAM_ROWS; r++) {
+        int first = (int)ceilf(rowFreq[r] / binHz);
+        int last = (int)ceilf(rowFreq[r + 1] / binHz);
+        if (last > bins) last = bins;
+        if (first >= last) {
+            first = (int)(rowFreq[r] / binHz);
+            if (first > bins - 1) first = bins - 1;
+            last = first + 1;
+        }
+        rowFirst[r] = first;
+        rowLast[r] = last;
+    }
+}
+
+// log2 from the float's exponent plus a quadratic fit of log2(m) + 1 over the mantissa
+// m in [1, 2) (max error ~0.005, 0.03 dB: far below one 8-bit step of SPECTROGRAM_RANGE_DB / 255).
+static inline float FastLog2(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    float exponent = (float)((int)((bits >> 23) & 0xFF) - 128);
+    bits = (bits & 0x007FFFFF) | 0x3F800000;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    return exponent + (-0.34484843f * m + 2.02466578f) * m - 0.67487759f;
+}
+
+void SpectrogramRing::PushColumn(const float* magnitude, int bins, float binHz) {
+    if (bins < 2 || binHz <= 0.0f) return;
+    if (bins != mapBins || binHz != mapBinHz) BuildRowMap(bins, binHz);
+
+    // level = (20 log10(peak / full scale) - FLOOR_DB) * 255 / RANGE_DB, folded into one multiply-add on log2
+    const float dbPerLog2 = 20.0f * 0.30103f;
+    const float scale = dbPerLog2 * 255.0f / SPECTROGRAM_RANGE_DB;
+    const float offset = (-dbPerLog2 * log2f(FULL_SCALE_MAGNITUDE) - SPECTROGRAM_FLOOR_DB) * 255.0f / SPECTROGRAM_RANGE_DB;
+    const float silence = 1e-9f;
+
+    uint64_t count = written.load(std::memory_order_relaxed);
+    uint8_t* column = data + (size_t)(count % SPECTROGRAM_COLUMNS) * SPECTROGRAM_ROWS;
+    for (int r = 0; r < SPECTROGRAM_ROWS; r++) {
+        // Peak, not mean: a log-spaced top row spans hundreds of bins and would smear tones away
+        float peak = silence;
+        for (int b = rowFirst[r]; b < rowLast[r]; b++) {
+            if (magnitude[b] > peak) peak = magnitude[b];
+        }
+        float level = FastLog2(peak) * scale + offset;
+        column[r] = (uint8_t)(level <= 0.0f ? 0.0f : (level >= 255.0f ? 255.0f : level + 0.5f));
+    }
+    written.store(count + 1, std::memory_order_release);
+}
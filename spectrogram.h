@@ -0,0 +1,62 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// =========================================================
+// SPECTROGRAM HISTORY RING
+// =========================================================
+// A fixed columns x rows ring of 8-bit log-magnitude spectra. Each analysis hop
+// quantizes its spectrum into the next column in place; nothing ever scrolls in
+// memory. Columns are stored contiguously (column-major), so one column is
+// exactly the pixel data of a 1 x rows texture sub-rectangle and a renderer
+// uploads only the columns written since its last frame (see spectrogramview.h).
+//
+// One writer (the analysis thread) and one reader (the render thread). The writer
+// publishes a column with a release store of the column count; a reader more than
+// a whole ring behind simply re-reads everything.
+
+#define SPECTROGRAM_COLUMNS   512       // Hops of history
+#define SPECTROGRAM_ROWS      256       // Log-spaced frequency rows
+#define SPECTROGRAM_MIN_FREQ  30.0f     // Bottom row; the top row ends at Nyquist
+#define SPECTROGRAM_FLOOR_DB  -80.0f    // Quantized to 0
+#define SPECTROGRAM_RANGE_DB  80.0f     // FLOOR_DB + RANGE_DB is quantized to 255
+
+class SpectrogramRing {
+public:
+    SpectrogramRing();
+    ~SpectrogramRing();
+
+    // --- WRITER SIDE ---
+
+    // Quantize one magnitude spectrum (bins values, pre-scaled to the FFT_SIZE
+    // reference like every analysis spectrum) into the next column. `binHz` is the
+    // bin spacing; the row -> bin map is rebuilt only when bins or binHz change.
+    void PushColumn(const float* magnitude, int bins, float binHz);
+
+    // --- READER SIDE ---
+
+    // Columns written since the start (the newest is column (GetWritten() - 1) % SPECTROGRAM_COLUMNS).
+    uint64_t GetWritten() const { return written.load(std::memory_order_acquire); }
+
+    // SPECTROGRAM_ROWS bytes, lowest frequency first.
+    const uint8_t* GetColumn(int column) const { return data + (size_t)column * SPECTROGRAM_ROWS; }
+
+    // Bottom frequency (Hz) of `row` for the last configured spectrum.
+    float GetRowFreq(int row) const { return rowFreq[row]; }
+
+private:
+    void BuildRowMap(int bins, float binHz);
+
+    uint8_t* data;                              // SPECTROGRAM_COLUMNS x SPECTROGRAM_ROWS, column-major
+    int mapBins;
+    float mapBinHz;
+    int rowFirst[SPECTROGRAM_ROWS];             // Row covers bins [rowFirst, rowLast)
+    int rowLast[SPECTROGRAM_ROWS];
+    float rowFreq[SPECTROGRAM_ROWS + 1];
+    std::atomic<uint64_t> written;
+};
+
+#endif // SPECTROGRAM_H
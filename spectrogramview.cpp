@@ -0,0 +1,59 @@
+#include "spectrogramview.h"
+
+SpectrogramView::SpectrogramView() : texture{}, uploaded(0) {}
+
+void SpectrogramView::Init() {
+    if (texture.id != 0) return;
+    Image blank = GenImageColor(SPECTROGRAM_COLUMNS, SPECTROGRAM_ROWS, BLACK);
+    ImageFormat(&blank, PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+    texture = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+    // Default point filtering: bilinear would bleed the newest column into the oldest at the wrap seam
+    uploaded = 0;
+}
+
+void SpectrogramView::Unload() {
+    if (texture.id != 0) UnloadTexture(texture);
+    texture = Texture2D{};
+    uploaded = 0;
+}
+
+void SpectrogramView::Update(const SpectrogramRing& ring) {
+    if (texture.id == 0) return;
+    uint64_t written = ring.GetWritten();
+    if (written == uploaded) return;
+
+    // A reader a ring or more behind (first frame, a stalled window) re-sends every slot
+    // once, except slot written % SPECTROGRAM_COLUMNS: the writer fills that one next, so
+    // it is skipped and arrives with the following column.
+    uint64_t first = uploaded;
+    if (written - first >= SPECTROGRAM_COLUMNS) first = written - SPECTROGRAM_COLUMNS + 1;
+
+    for (uint64_t c = first; c < written; c++) {
+        int column = (int)(c % SPECTROGRAM_COLUMNS);
+        // Columns are contiguous in the ring, so each one is exactly a 1 x rows sub-image
+        Rectangle rect = { (float)column, 0.0f, 1.0f, (float)SPECTROGRAM_ROWS };
+        UpdateTextureRec(texture, rect, ring.GetColumn(column));
+    }
+    uploaded = written;
+}
+
+void SpectrogramView::Draw(Rectangle bounds, Color tint) const {
+    if (texture.id == 0 || bounds.width <= 0.0f || bounds.height <= 0.0f) return;
+
+    // Slot `head` holds the oldest column: draw [head, end) then [0, head)
+    int head = (int)(uploaded % SPECTROGRAM_COLUMNS);
+    float columnWidth = bounds.width / (float)SPECTROGRAM_COLUMNS;
+    float olderWidth = (float)(SPECTROGRAM_COLUMNS - head) * columnWidth;
+
+    // Negative source height flips the texture so row 0 (lowest frequency) is at the bottom
+    Rectangle older = { (float)head, 0.0f, (float)(SPECTROGRAM_COLUMNS - head), -(float)SPECTROGRAM_ROWS };
+    Rectangle olderDest = { bounds.x, bounds.y, olderWidth, bounds.height };
+    DrawTexturePro(texture, older, olderDest, Vector2{ 0.0f, 0.0f }, 0.0f, tint);
+
+    if (head > 0) {
+        Rectangle newer = { 0.0f, 0.0f, (float)head, -(float)SPECTROGRAM_ROWS };
+        Rectangle newerDest = { bounds.x + olderWidth, bounds.y, bounds.width - olderWidth, bounds.height };
+        DrawTexturePro(texture, newer, newerDest, Vector2{ 0.0f, 0.0f }, 0.0f, tint);
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SPECTROGRAMVIEW_H
+#define SPECTROGRAMVIEW_H
+
+#include <cstdint>
+#include "raylib.h"
+#include "spectrogram.h"
+
+// =========================================================
+// SPECTROGRAM TEXTURE
+// =========================================================
+// GPU mirror of a SpectrogramRing: one 8-bit grayscale texture of
+// SPECTROGRAM_COLUMNS x SPECTROGRAM_ROWS texels that is never rebuilt. Each frame
+// only the columns written since the last frame are uploaded (UpdateTextureRec on
+// a 1 x rows rectangle), and the ring is drawn scrolled by splitting it at the
+// write position instead of moving any pixels.
+
+class SpectrogramView {
+public:
+    SpectrogramView();
+
+    // Need a window (GL context). Init is safe to call again; only the first call loads.
+    void Init();
+    void Unload();
+
+    // Upload the columns the ring gained since the last call (render thread only).
+    void Update(const SpectrogramRing& ring);
+
+    // Oldest column at the left edge, newest at the right, low frequencies at the bottom.
+    void Draw(Rectangle bounds, Color tint) const;
+
+private:
+    Texture2D texture;
+    uint64_t uploaded;      // Ring columns already on the GPU
+};
+
+#endif // SPECTROGRAMVIEW_H
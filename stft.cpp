@@ -0,0 +1,146 @@
+#include "stft.h"
+#include <map>
+#include <mutex>
+#include <utility>
+#include <cmath>
+#include <cstring>
+
+// =========================================================
+// WINDOW TABLES
+// =========================================================
+
+static const double TWO_PI = 6.283185307179586;
+
+static std::map<std::pair<int, int>, float*> windowCache;
+static std::mutex windowMutex;
+
+const char* GetWindowName(int type) {
+    switch (type) {
+        case WINDOW_HANN:     return "Hann";
+        case WINDOW_BLACKMAN: return "Blackman";
+        default:              return "Unknown";
+    }
+}
+
+const float* GetWindowTable(int type, int size) {
+    if (size <= 0 || type < 0 || type >= WINDOW_TYPE_COUNT) return nullptr;
+
+    std::lock_guard<std::mutex> lock(windowMutex);
+    auto key = std::make_pair(type, size);
+    auto it = windowCache.find(key);
+    if (it != windowCache.end()) return it->second;
+
+    float* table = AllocAlignedFloats(size);
+    if (!table) return nullptr;
+
+    // Periodic windows (denominator N) so overlapping hops sum flat
+    double sum = 0.0;
+    for (int i = 0; i < size; i++) {
+        double phase = TWO_PI * (double)i / (double)size;
+        double w;
+        if (type == WINDOW_BLACKMAN) w = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+        else                         w = 0.5 - 0.5 * cos(phase);
+        table[i] = (float)w;
+        sum += w;
+    }
+
+    float scale = (float)(FFT_SIZE / sum);
+    for (int i = 0; i < size; i++) {
+        table[i] *= scale;
+    }
+
+    windowCache[key] = table;
+    return table;
+}
+
+void ClearWindowTables() {
+    std::lock_guard<std::mutex> lock(windowMutex);
+    for (auto& entry : windowCache) {
+        FreeAligned(entry.second);
+    }
+    windowCache.clear();
+}
+
+// =========================================================
+// STFT
+// =========================================================
+
+STFTAnalyzer::STFTAnalyzer()
+    : window(nullptr), history(nullptr), historyPos(0), hopSize(0),
+      windowType(WINDOW_HANN), samplesSinceHop(0), samplePosition(0)
+{
+}
+
+STFTAnalyzer::~STFTAnalyzer() {
+    FreeAligned(history);
+    FreeSpectrum(spectrum);
+}
+
+bool STFTAnalyzer::Configure(int fftSize, int hop, int type) {
+    if (hop <= 0 || hop > fftSize) return false;
+
+    const float* table = GetWindowTable(type, fftSize);
+    if (!table) return false;
+
+    if (spectrum.fftSize != fftSize) {
+        if (!AllocSpectrum(spectrum, fftSize)) return false;
+        FreeAligned(history);
+        history = AllocAlignedFloats(fftSize);
+        if (!history) {
+            FreeSpectrum(spectrum);
+            return false;
+        }
+    }
+
+    window = table;
+    hopSize = hop;
+    windowType = type;
+    Reset();
+    return true;
+}
+
+void STFTAnalyzer::Reset() {
+    if (history) memset(history, 0, sizeof(float) * spectrum.fftSize);
+    historyPos = 0;
+    samplesSinceHop = 0;
+    samplePosition = 0;
+}
+
+int STFTAnalyzer::Feed(const float* samples, int count) {
+    if (!history || count <= 0) return 0;
+
+    int n = spectrum.fftSize;
+    int take = hopSize - samplesSinceHop;
+    if (take > count) take = count;
+    if (take <= 0) return 0;
+
+    // Copy in at most two runs around the wrap point
+    int first = n - historyPos;
+    if (first > take) first = take;
+    memcpy(history + historyPos, samples, sizeof(float) * first);
+    if (take > first) memcpy(history, samples + first, sizeof(float) * (take - first));
+
+    historyPos = (historyPos + take) % n;
+    samplesSinceHop += take;
+    samplePosition += (uint64_t)take;
+    return take;
+}
+
+void STFTAnalyzer::Transform() {
+    if (!history) return;
+
+    // historyPos is the oldest sample; unroll the ring into the FFT input while windowing
+    int n = spectrum.fftSize;
+    int tail = n - historyPos;
+    const float* older = history + historyPos;
+    float* out = spectrum.input;
+    for (int i = 0; i < tail; i++) {
+        out[i] = older[i] * window[i];
+    }
+    for (int i = 0; i < historyPos; i++) {
+        out[tail + i] = history[i] * window[tail + i];
+    }
+
+    TransformSpectrum(spectrum);
+    samplesSinceHop = 0;
+}
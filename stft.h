@@ -0,0 +1,70 @@
+#ifndef STFT_H
+#define STFT_H
+
+#include <cstdint>
+#include "fft.h"
+
+#define STFT_DEFAULT_SIZE 2048
+#define STFT_DEFAULT_HOP  256
+
+enum WindowType {
+    WINDOW_HANN,
+    WINDOW_BLACKMAN,
+    WINDOW_TYPE_COUNT
+};
+
+const char* GetWindowName(int type);
+
+// Cached, aligned window table. Coefficients are scaled so a sine reads the same
+// magnitude as it would in an unwindowed FFT_SIZE block, which keeps
+// BASS_NORM_FACTOR meaningful for every window and size.
+const float* GetWindowTable(int type, int size);
+void ClearWindowTables();
+
+// =========================================================
+// OVERLAPPING STFT
+// =========================================================
+// Samples go into a history ring of fftSize; every hopSize samples the newest
+// fftSize samples are windowed and transformed.
+//
+//   int offset = 0;
+//   while (offset < count) {
+//       offset += stft.Feed(samples + offset, count - offset);
+//       if (stft.HopReady()) { stft.Transform(); ... stft.GetSpectrum() ... }
+//   }
+
+class STFTAnalyzer {
+public:
+    STFTAnalyzer();
+    ~STFTAnalyzer();
+
+    bool Configure(int fftSize, int hopSize, int windowType);
+    void Reset();
+
+    // Append samples up to the next hop boundary. Returns how many were consumed.
+    int Feed(const float* samples, int count);
+    bool HopReady() const { return samplesSinceHop >= hopSize; }
+
+    // Window the newest fftSize samples and run the FFT.
+    void Transform();
+
+    const FFTSpectrum& GetSpectrum() const { return spectrum; }
+    int GetFFTSize() const { return spectrum.fftSize; }
+    int GetHopSize() const { return hopSize; }
+    int GetWindowType() const { return windowType; }
+
+    // Total samples fed since the last Configure/Reset (end of the current frame).
+    uint64_t GetSamplePosition() const { return samplePosition; }
+
+private:
+    FFTSpectrum spectrum;
+    const float* window;
+    float* history;
+    int historyPos;
+    int hopSize;
+    int windowType;
+    int samplesSinceHop;
+    uint64_t samplePosition;
+};
+
+#endif // STFT_H
@@ -0,0 +1,53 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// =========================================================
+// LOCK-FREE TRIPLE BUFFER
+// =========================================================
+// One writer, one reader, three preallocated slots. The writer fills its private
+// slot and swaps it with the shared middle slot; the reader swaps the middle slot
+// for its own only when something new was published. Neither side ever waits or
+// copies, and the reader's slot stays untouched until its next Acquire(), so it
+// can be read in place for a whole frame.
+
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : writeIndex(0), readIndex(2), middle(1) {}
+
+    // --- WRITER SIDE ---
+    T& GetWriteBuffer() { return slots[writeIndex]; }
+
+    // Hand the write buffer to the reader. The next GetWriteBuffer() returns a different slot
+    // holding stale contents, so writers must fill every field they publish.
+    void Publish() {
+        uint8_t previous = middle.exchange((uint8_t)(writeIndex | FRESH_BIT), std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // --- READER SIDE ---
+    // Newest published slot. Valid and unchanged until the next Acquire().
+    const T& Acquire() {
+        if (middle.load(std::memory_order_relaxed) & FRESH_BIT) {
+            uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+        }
+        return slots[readIndex];
+    }
+
+    bool HasFresh() const { return (middle.load(std::memory_order_relaxed) & FRESH_BIT) != 0; }
+
+private:
+    static const uint8_t INDEX_MASK = 0x3;
+    static const uint8_t FRESH_BIT = 0x4;
+
+    T slots[3];
+    uint8_t writeIndex;     // Writer thread only
+    uint8_t readIndex;      // Reader thread only
+    std::atomic<uint8_t> middle;
+};
+
+#endif // TRIPLEBUFFER_H
@@ -1,10 +1,8 @@
 #include "waveform.h"
 #include "raylib.h"
 #include <vector>
-#include <deque>
 #include <iostream>
 #include <algorithm>
-#include <numeric>
 #include <cmath>
 #include "globals.h" // Include globals to access enableInterpolation
 
@@ -16,7 +14,6 @@ extern float waveform_height_scale;
 extern float waveform_smoothing_factor;
 extern float control_sensitivity;
 extern float control_brightness_floor;
-extern std::vector<std::deque<float>> waveform_buffers;
 
 // Constant for maximum line thickness
 const float MAX_LINE_THICKNESS = 16.0f;
@@ -47,26 +44,18 @@ Waveform::Waveform(int control_waveform_points,
     waveform_buffers.resize(control_waveform_points);
 }
 
-void Waveform::updateWaveformBuffers() {
-    for (size_t i = 0; i < waveform_buffers.size(); ++i) {
-        if (waveform_buffers[i].size() > 100) {
-            waveform_buffers[i].pop_front();
-        }
-    }
-}
-
-void Waveform::drawWaveformWrapper(const std::vector<float>& audio_data, Color orbColor) {
+void Waveform::drawWaveformWrapper(FloatSpan audio_data, Color orbColor) {
     drawWaveform(audio_data, orbColor);
 }
 
-void Waveform::drawWaveform(const std::vector<float>& latest_audio_data, Color orbColor) {
+void Waveform::drawWaveform(FloatSpan latest_audio_data, Color orbColor) {
     try {
-        if (latest_audio_data.empty() || latest_audio_data.size() < 2) {
+        if (latest_audio_data.empty() || latest_audio_data.size < 2) {
             return;
         }
 
-        int downsample_factor = std::max(1, static_cast<int>(latest_audio_data.size()) / control_waveform_points);
-        std::vector<float> downsampled_waveform(latest_audio_data.size() / downsample_factor);
+        int downsample_factor = std::max(1, static_cast<int>(latest_audio_data.size) / control_waveform_points);
+        downsampled_waveform.resize(latest_audio_data.size / downsample_factor);
 
         for (size_t i = 0; i < downsampled_waveform.size(); ++i) {
             downsampled_waveform[i] = latest_audio_data[i * downsample_factor];
@@ -77,10 +66,17 @@ void Waveform::drawWaveform(const std::vector<float>& latest_audio_data, Color o
         if (enableInterpolation) {
             for (size_t i = 0; i < downsampled_waveform.size(); ++i) {
                 if (i < waveform_buffers.size()) {
+                    WaveformHistory& history = waveform_buffers[i];
                     if (downsampled_waveform[i] > 0) {
-                        waveform_buffers[i].push_back(downsampled_waveform[i]);
+                        // Full ring: the new sample replaces the oldest
+                        if (history.count == WAVEFORM_HISTORY) history.sum -= history.values[history.next];
+                        else history.count++;
+                        history.values[history.next] = downsampled_waveform[i];
+                        history.sum += downsampled_waveform[i];
+                        history.next = (history.next + 1) % WAVEFORM_HISTORY;
                     }
-                    float smoothed_val = std::accumulate(waveform_buffers[i].begin(), waveform_buffers[i].end(), 0.0f) / waveform_buffers[i].size();
+                    if (history.count == 0) continue;
+                    float smoothed_val = (float)(history.sum / history.count);
                     downsampled_waveform[i] = (waveform_smoothing_factor * smoothed_val) +
                                               (1.0f - waveform_smoothing_factor) * downsampled_waveform[i];
                 }
@@ -102,7 +98,7 @@ void Waveform::drawWaveform(const std::vector<float>& latest_audio_data, Color o
         }
 
         float x_step = static_cast<float>(GetScreenWidth()) / (num_points - 1);
-        std::vector<Vector2> points;
+        points.clear();
 
         for (size_t i = 0; i < num_points - 1; ++i) {
             // Internal interpolation factor: if smoothing is OFF, we use 1.0 to skip extra points
@@ -2,11 +2,21 @@
 #define WAVEFORM_H
 
 #include <vector>
-#include <deque>
 #include "raylib.h"
+#include "floatspan.h"
 
 extern Shader waveformShader;  // Declare the shader variable
 
+#define WAVEFORM_HISTORY 100    // Samples per point averaged by the interpolation smoothing
+
+// Last WAVEFORM_HISTORY positive samples of one point, preallocated, with their running sum
+struct WaveformHistory {
+    float values[WAVEFORM_HISTORY] = {};
+    int count = 0;
+    int next = 0;
+    double sum = 0.0;
+};
+
 class Waveform {
 public:
     // Constructor
@@ -18,12 +28,10 @@ public:
              float control_sensitivity,
              float hue_value);
 
-    // Method to update waveform buffers if needed (e.g., for smoothing or other processing)
-    void updateWaveformBuffers();
-
     // Method to draw the waveform
-    void drawWaveformWrapper(const std::vector<float>& audio_data, Color orbColor);  // Add orbColor parameter
-    void drawWaveform(const std::vector<float>& latest_audio_data, Color orbColor);  // Modify drawWaveform
+    // Samples are read in place (e.g. VisualFrame::GetPCM()); nothing is copied or allocated per frame
+    void drawWaveformWrapper(FloatSpan audio_data, Color orbColor);  // Add orbColor parameter
+    void drawWaveform(FloatSpan latest_audio_data, Color orbColor);  // Modify drawWaveform
 
 private:
     int control_waveform_points;
@@ -33,7 +41,11 @@ private:
     float control_sensitivity;
     float glow_value;
     float hue_value;
-    std::vector<std::deque<float>> waveform_buffers;
+    std::vector<WaveformHistory> waveform_buffers;  // One per point, sized in the constructor
+
+    // Scratch reused across frames (capacity only ever grows)
+    std::vector<float> downsampled_waveform;
+    std::vector<Vector2> points;
 };
 
 #endif  // WAVEFORM_H
@@ -0,0 +1,136 @@
+#include "wavfile.h"
+#include "audiosource.h"
+#include <cstring>
+
+#define WAVE_FORMAT_PCM        0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
+static uint32_t ReadU32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t ReadU16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+WavReader::WavReader()
+    : file(nullptr), sampleRate(0), channels(0), bitsPerSample(0), isFloat(false),
+      frameBytes(0), totalFrames(0), framesLeft(0), error(nullptr)
+{
+}
+
+WavReader::~WavReader() {
+    Close();
+}
+
+bool WavReader::Fail(const char* message) {
+    error = message;
+    Close();
+    return false;
+}
+
+void WavReader::Close() {
+    if (file) fclose(file);
+    file = nullptr;
+}
+
+bool WavReader::Open(const char* path) {
+    Close();
+    error = nullptr;
+
+    file = fopen(path, "rb");
+    if (!file) return Fail("cannot open file");
+
+    unsigned char header[12];
+    if (fread(header, 1, 12, file) != 12 || memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0) {
+        return Fail("not a RIFF/WAVE file");
+    }
+
+    bool haveFormat = false;
+    unsigned char chunkHeader[8];
+    while (fread(chunkHeader, 1, 8, file) == 8) {
+        uint32_t size = ReadU32(chunkHeader + 4);
+
+        if (memcmp(chunkHeader, "fmt ", 4) == 0) {
+            unsigned char fmt[40] = {};
+            uint32_t toRead = size < sizeof(fmt) ? size : (uint32_t)sizeof(fmt);
+            if (size < 16 || fread(fmt, 1, toRead, file) != toRead) return Fail("bad fmt chunk");
+            if (size > toRead) fseek(file, (long)(size - toRead), SEEK_CUR);
+
+            uint16_t format = ReadU16(fmt);
+            channels      = ReadU16(fmt + 2);
+            sampleRate    = (int)ReadU32(fmt + 4);
+            bitsPerSample = ReadU16(fmt + 14);
+            if (format == WAVE_FORMAT_EXTENSIBLE && size >= 26) format = ReadU16(fmt + 24);
+
+            isFloat = (format == WAVE_FORMAT_IEEE_FLOAT);
+            if (format != WAVE_FORMAT_PCM && !isFloat) return Fail("unsupported sample format");
+            if (isFloat && bitsPerSample != 32) return Fail("only 32-bit float is supported");
+            if (!isFloat && bitsPerSample != 16 && bitsPerSample != 24 && bitsPerSample != 32) return Fail("unsupported bit depth");
+            if (channels < 1 || channels > 8) return Fail("unsupported channel count");
+            if (sampleRate < MIN_SAMPLE_RATE || sampleRate > MAX_SAMPLE_RATE) return Fail("unsupported sample rate");
+
+            frameBytes = channels * (bitsPerSample / 8);
+            haveFormat = true;
+        }
+        else if (memcmp(chunkHeader, "data", 4) == 0) {
+            if (!haveFormat) return Fail("data chunk before fmt chunk");
+            totalFrames = size / (uint32_t)frameBytes;
+            framesLeft = totalFrames;
+            return true;
+        }
+        else {
+            // Chunks are word aligned
+            fseek(file, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+
+    return Fail("no data chunk");
+}
+
+float WavReader::DecodeSample(const unsigned char* data) const {
+    if (isFloat) {
+        float value;
+        memcpy(&value, data, sizeof(float));
+        return value;
+    }
+    switch (bitsPerSample) {
+        case 16: return (float)(int16_t)ReadU16(data) / 32768.0f;
+        case 24: return (float)((int32_t)(((uint32_t)data[0] << 8) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 24)) >> 8) / 8388608.0f;
+        default: return (float)(int32_t)ReadU32(data) / 2147483648.0f;
+    }
+}
+
+int WavReader::ReadMono(float* out, int frames) {
+    if (!file) return 0;
+
+    int done = 0;
+    int sampleBytes = bitsPerSample / 8;
+    float invChannels = 1.0f / (float)channels;
+
+    while (done < frames && framesLeft > 0) {
+        int want = frames - done;
+        if (want > WAV_READ_CHUNK_FRAMES) want = WAV_READ_CHUNK_FRAMES;
+        if ((uint64_t)want > framesLeft) want = (int)framesLeft;
+
+        int got = (int)(fread(chunk, (size_t)frameBytes, (size_t)want, file));
+        if (got <= 0) {
+            framesLeft = 0;
+            break;
+        }
+
+        for (int f = 0; f < got; f++) {
+            const unsigned char* frame = chunk + (size_t)f * frameBytes;
+            float sum = 0.0f;
+            for (int c = 0; c < channels; c++) {
+                sum += DecodeSample(frame + c * sampleBytes);
+            }
+            out[done + f] = sum * invChannels;
+        }
+
+        done += got;
+        framesLeft -= (uint64_t)got;
+    }
+    return done;
+}
@@ -0,0 +1,49 @@
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <cstdio>
+#include <cstdint>
+
+// =========================================================
+// STREAMING WAV READER
+// =========================================================
+// PCM 16/24/32-bit and IEEE float 32-bit, any channel count (including
+// WAVE_FORMAT_EXTENSIBLE). Frames are read in chunks and mixed down to mono,
+// so files of any length stream with a fixed amount of memory.
+
+#define WAV_READ_CHUNK_FRAMES 1024
+
+class WavReader {
+public:
+    WavReader();
+    ~WavReader();
+
+    bool Open(const char* path);
+    void Close();
+
+    // Read up to `frames` mono frames. Returns frames read (0 at end of data).
+    int ReadMono(float* out, int frames);
+
+    bool IsOpen() const { return file != nullptr; }
+    int GetSampleRate() const { return sampleRate; }
+    int GetChannels() const { return channels; }
+    uint64_t GetTotalFrames() const { return totalFrames; }
+    const char* GetError() const { return error; }
+
+private:
+    bool Fail(const char* message);
+    float DecodeSample(const unsigned char* data) const;
+
+    FILE* file;
+    int sampleRate;
+    int channels;
+    int bitsPerSample;
+    bool isFloat;
+    int frameBytes;
+    uint64_t totalFrames;
+    uint64_t framesLeft;
+    const char* error;
+    unsigned char chunk[WAV_READ_CHUNK_FRAMES * 8 * 4];    // Up to 8 channels of 32-bit samples
+};
+
+#endif // WAVFILE_H
@@ -0,0 +1,96 @@
+#include "workerpool.h"
+
+#define WORKER_POOL_RESERVED_CORES 2    // Audio callback / source thread and the analysis thread
+
+WorkerPool::WorkerPool()
+    : task(nullptr), chunkCount(0), nextChunk(0), busyWorkers(0), generation(0), stopping(false) {}
+
+WorkerPool::~WorkerPool() {
+    Stop();
+}
+
+void WorkerPool::Start(int threads) {
+    Stop();
+    if (threads > WORKER_POOL_MAX_THREADS) threads = WORKER_POOL_MAX_THREADS;
+    uint64_t current;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+        current = generation;
+    }
+    for (int t = 1; t < threads; t++) {
+        workers.emplace_back(&WorkerPool::WorkerMain, this, t, current);
+    }
+}
+
+void WorkerPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+}
+
+void WorkerPool::ParallelFor(int chunks, const std::function<void(int, int)>& loopTask) {
+    if (chunks <= 0) return;
+
+    // Not worth a wake-up
+    if (workers.empty() || chunks == 1) {
+        for (int c = 0; c < chunks; c++) loopTask(c, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &loopTask;
+        chunkCount = chunks;
+        nextChunk.store(0, std::memory_order_relaxed);
+        busyWorkers = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    RunChunks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busyWorkers == 0; });
+    task = nullptr;
+}
+
+void WorkerPool::WorkerMain(int thread, uint64_t seen) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        RunChunks(thread);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) done.notify_one();
+    }
+}
+
+void WorkerPool::RunChunks(int thread) {
+    for (;;) {
+        int chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunkCount) break;
+        (*task)(chunk, thread);
+    }
+}
+
+int ResolveWorkerThreads(int requested) {
+    int threads = requested;
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency() - WORKER_POOL_RESERVED_CORES;
+    }
+    if (threads < 1) threads = 1;
+    if (threads > WORKER_POOL_MAX_THREADS) threads = WORKER_POOL_MAX_THREADS;
+    return threads;
+}
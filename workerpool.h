@@ -0,0 +1,56 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// =========================================================
+// WORKER POOL
+// =========================================================
+// Persistent threads for data-parallel loops on the render thread. ParallelFor
+// hands chunks out through an atomic counter; the calling thread takes chunks
+// too and returns once every chunk is done, so to the caller it is a plain
+// synchronous loop. One ParallelFor at a time, from the thread that owns the pool.
+
+#define WORKER_POOL_MAX_THREADS 64
+
+class WorkerPool {
+public:
+    WorkerPool();
+    ~WorkerPool();
+
+    // Total threads including the caller; 1 (or less) runs every loop inline.
+    void Start(int threads);
+    void Stop();
+    int GetThreadCount() const { return (int)workers.size() + 1; }
+
+    // Calls task(chunk, thread) for every chunk in [0, chunks). `thread` is in
+    // [0, GetThreadCount()), 0 being the caller; it indexes per-thread state.
+    void ParallelFor(int chunks, const std::function<void(int, int)>& task);
+
+private:
+    void WorkerMain(int thread, uint64_t seen); // seen: generation at Start, so restarts skip stale jobs
+    void RunChunks(int thread);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int, int)>* task;
+    int chunkCount;
+    std::atomic<int> nextChunk;
+    int busyWorkers;                // Workers still inside the current loop
+    uint64_t generation;            // Bumped once per ParallelFor
+    bool stopping;
+};
+
+// Threads to use for `requested` (0 = all cores but the ones the audio and
+// analysis threads keep busy), clamped to 1..WORKER_POOL_MAX_THREADS.
+int ResolveWorkerThreads(int requested);
+
+#endif // WORKERPOOL_H